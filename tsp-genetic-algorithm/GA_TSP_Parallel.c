@@ -1,16 +1,29 @@
+#define _POSIX_C_SOURCE 200112L // posix_memalign
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 #include <omp.h>
 
-#define NUM_THRDS 4 //Default no. of threads set to 2
+#define NUM_THRDS 4 //Default no. of islands, each evolved by its own thread
+#define MIGRATION_INTERVAL 50 //Generations between two migrations
+#define MIGRANTS 2 //Best chromosomes sent to the next island of the ring at each migration
+#define MATRIX_ALIGNMENT 64 //Rows of the distance matrix start on cache line boundaries
+int num_islands = NUM_THRDS;
 int chromo_length; // Number of cities
 int popl_size; // Number of chromosomes
 int no_generation; //Number of iterations (Generations)
-float **dist_matrix; //Stores distance between cities
+float *dist_matrix; //Stores distance between cities, one flat matrix with rows of dist_stride floats
+size_t dist_stride;
 char citiesNameFile[255]; //Stores all city names
+unsigned long long ga_seed; //Seed of the random number generator, one generator per island is derived from it
+
+//Random number generator (xorshift128+) passed to the operators; every island has its own, no shared state
+typedef struct{
+    uint64_t state[2];
+} Rng;
 
 typedef struct{ //Structure used to store a city id and coordinate
     int id;
@@ -24,7 +37,14 @@ typedef struct{
     int * genes;
     float fitness;
 } Chromosome;
-Chromosome * population;
+
+//Sub-population evolved independently by one thread, exchanging its best chromosomes with the next island
+typedef struct{
+    Chromosome *population;
+    int *migrant_genes; //Copies of the best chromosomes, read by the next island at a migration
+    unsigned char *visited; //Cities already placed in the child being built by the island's crossover
+    Rng rng;
+} Island;
 
 //Prints the fitness value and the path of a chromosome
 void print_chromosome(Chromosome *ptr_chromosome){
@@ -42,15 +62,44 @@ void print_population(Chromosome *population){
         print_chromosome(&population[i]);
 }
 
-//Accepts the input filename to extract cities' coordinates
+//Accepts the input filename to extract cities' coordinates, and the optional seed and number of islands
 void parse_arguments(int argc, char **argv){
-    if (argc != 2){
-        printf("Must submit TSP locations test file name as argument.\n");
+    ga_seed = (unsigned long long)time(NULL);
+    int valid = argc >= 2 && argc % 2 == 0;
+    for (int i = 2; valid && i < argc; i += 2){
+        if (strcmp(argv[i], "--seed") == 0)
+            ga_seed = strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--islands") == 0)
+            num_islands = atoi(argv[i + 1]);
+        else
+            valid = 0;
+    }
+    if (!valid || num_islands < 1){
+        printf("Must submit TSP locations test file name as argument (and optionally --seed <n>, --islands <n>).\n");
         exit(0);
-    } 
-    else{
-        strcpy(citiesNameFile, argv[1]);
     }
+    strcpy(citiesNameFile, argv[1]);
+}
+
+//Initializes the generator state from a seed (splitmix64)
+void rng_seed(Rng *rng, uint64_t seed){
+    for(int i = 0; i < 2; i++){
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        rng->state[i] = z ^ (z >> 31);
+    }
+}
+
+//Random int in [0, bound)
+int rng_int(Rng *rng, int bound){
+    uint64_t s1 = rng->state[0];
+    const uint64_t s0 = rng->state[1];
+    rng->state[0] = s0;
+    s1 ^= s1 << 23;
+    rng->state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return (int)((((rng->state[1] + s0) >> 32) * (uint64_t)bound) >> 32);
 }
 
 //Performs the file reading operation
@@ -95,7 +144,7 @@ void print_dist_matrix(){
     for (int i = 0; i < chromo_length; ++i){
         printf("\n|%d|\t", i);
         for (int j = 0; j < chromo_length; j++)
-            printf("(%d,%d) = %.4f\t",i,j, dist_matrix[i][j]);
+            printf("(%d,%d) = %.4f\t",i,j, dist_matrix[i * dist_stride + j]);
     }
     printf("\n");
 #endif
@@ -103,67 +152,66 @@ void print_dist_matrix(){
 
 //Initialising distance matrix after reading from file
 void init_dist_matrix(){
+    void *matrix;
     read_cities_from_file();
-    dist_matrix = malloc(sizeof (float *) * chromo_length);
+    dist_stride = ((size_t)chromo_length + 15) & ~(size_t)15; //Whole cache lines of 16 floats
+    if (posix_memalign(&matrix, MATRIX_ALIGNMENT, chromo_length * dist_stride * sizeof (float)) != 0){
+        printf("Not enough memory for the distances of %d cities.\n", chromo_length);
+        exit(0);
+    }
+    dist_matrix = matrix;
 
-    //Memory creation is parallelised
-    #pragma omp parallel for num_threads(NUM_THRDS)
-    for (int i = 0; i < chromo_length; i++)
-        dist_matrix[i] = calloc(chromo_length, sizeof (float));
-        
     //Distance calculation is parallelised
-    #pragma omp parallel for num_threads(NUM_THRDS)
+    #pragma omp parallel for num_threads(num_islands)
     for (int i = 0; i < chromo_length - 1; i++){
         for (int j = i + 1; j < chromo_length; j++){
             float distance = get_distance(cities[i], cities[j]);
-            dist_matrix[i][j] = dist_matrix[j][i] = distance;
+            dist_matrix[i * dist_stride + j] = dist_matrix[j * dist_stride + i] = distance;
         }
+        dist_matrix[i * dist_stride + i] = 0.0f;
     }
+    dist_matrix[(chromo_length - 1) * dist_stride + chromo_length - 1] = 0.0f;
     free(cities);
 }
 
-//Calculates fitness value for each chromosome
-void calculate_fitness(Chromosome *ptr_chromosome){
-    float fitness = 0;
+//Length of the tour of a chromosome, back to its first city
+float tour_length(Chromosome *ptr_chromosome){
+    float length = 0;
     int i = 0;
 
-    //Critical Section required; omp parallel increases execution time, hence discarded
     for (i = 0; i < chromo_length-1; i++)
-        fitness += dist_matrix[ptr_chromosome->genes[i] -1][ptr_chromosome->genes[i+1] -1];
-        
-    fitness += dist_matrix[ptr_chromosome->genes[i]-1 ][0];
-    fitness = 10/log10(fitness);
-    ptr_chromosome-> fitness= fitness;
+        length += dist_matrix[(ptr_chromosome->genes[i] - 1) * dist_stride + ptr_chromosome->genes[i+1] - 1];
+
+    return length + dist_matrix[(ptr_chromosome->genes[i] - 1) * dist_stride + ptr_chromosome->genes[0] - 1];
 }
 
-//Send each chromosome to the above function
+//Calculates fitness value for each chromosome
+void calculate_fitness(Chromosome *ptr_chromosome){
+    ptr_chromosome-> fitness= 10/log10(tour_length(ptr_chromosome));
+}
+
+//Send each chromosome to the above function (an island is evolved by a single thread)
 void calculate_population_fitness(Chromosome *population){
-    //Section parallelised but yields no benefit as calculate_fitness() is already parallelised
-    #pragma omp parallel for num_threads(NUM_THRDS)
     for(int i = 0; i < popl_size; i++)
         calculate_fitness(&population[i]);
 }
 
-//Generating a random number using seeds
-int getRandomNumber(){
-	int seed = (unsigned)(time(NULL)+rand());
-	srand(seed);
-	return rand()%chromo_length;
+//Generating a random city index
+int getRandomNumber(Rng *rng){
+	return rng_int(rng, chromo_length);
 }
 
 //Initialising the chromosome path or solution as random
-void fill_randomly_the_chromosome(Chromosome *chrom){
+void fill_randomly_the_chromosome(Chromosome *chrom, Rng *rng){
 
     int array[chromo_length];
     chrom->genes = malloc(chromo_length * sizeof (int));
-    
-    //Initialising array is parallelised
-    #pragma omp parallel for num_threads(NUM_THRDS)
+
     for(int i = 0; i < chromo_length; i++)
         array[i] = i+1;
     
     for(int i = 0; i < chromo_length; i++){
-        int nbRand = getRandomNumber()%(chromo_length -i);
+        int nbRand = getRandomNumber(rng)%(chromo_length -i);
         int tmp = array[nbRand];
         array[nbRand] = array[chromo_length - i - 1];
         array[chromo_length - i - 1] = tmp;
@@ -179,40 +227,43 @@ void swap_chromosomes( Chromosome *pop, int src, int dest){
 	pop[dest] = chrom;
 }
 
-//Sorting population on the basis of fitness value
+//Orders chromosomes by descending fitness value (qsort comparator)
+int compare_fitness_desc(const void *a, const void *b){
+    float fa = ((const Chromosome *)a)->fitness;
+    float fb = ((const Chromosome *)b)->fitness;
+    return (fa < fb) - (fa > fb);
+}
+
+//Sorting population on the basis of fitness value in O(P log P)
 void sort_population(Chromosome *population){
 
-    // Not parallelizable
-    for(int i = 0; i < popl_size; i++)
-        for(int j = i+1; j < popl_size; j++)
-            if(population[i].fitness <population[j].fitness)
-                swap_chromosomes(population, i, j);
+    // Only moves the small structs, the genes stay in place
+    qsort(population, popl_size, sizeof(Chromosome), compare_fitness_desc);
 }
 
 //Generate a random chromosome index to be used during crossover
-int get_random_index_of_chrom(){
-    int seed = (unsigned)(time(NULL)+rand());
-    srand(seed);
-    return rand()%popl_size;
+int get_random_index_of_chrom(Rng *rng){
+    return rng_int(rng, popl_size);
 }
 
 //Selecting some chromosomes for crossover
-void selection(Chromosome *pop){
+void selection(Chromosome *pop, Rng *rng){
     int n = (40*popl_size)/100;
-    #pragma omp parallel for num_threads(NUM_THRDS)
     for(int i = 0; i < (10*popl_size)/100; i++){ //Swapping 10 chromosomes from the last 50% to the middle
-        int randNb =(popl_size/2) + get_random_index_of_chrom()%(popl_size/2);
-        swap_chromosomes(population, n+i, randNb);
+        int randNb =(popl_size/2) + get_random_index_of_chrom(rng)%(popl_size/2);
+        swap_chromosomes(pop, n+i, randNb);
     }
 }
 
 //Prints fitness value for all the chromosome 
-void print_fitness(){
+void print_fitness(Chromosome *population){
 #ifdef DEBUG
     printf("\n------------------------------------------------------Fitness-------------------------------------------\n");
     for(int i = 0; i < popl_size; i++)
         printf("%.3f - ",population[i].fitness);
     printf("\n------------------------------------------------------Fitness-------------------------------------------------\n");
+#else
+    (void)population;
 #endif
 }
 
@@ -228,105 +279,148 @@ float percentage_of_difference(Chromosome chro1, Chromosome chro2){
 	return (sum*100)/chromo_length;
 }
 
-//If a vertex exists in the chromosome
-int if_exist(Chromosome *chrom, int x){
-	for(int i=0; i<chromo_length; i++)
-		if(x == chrom->genes[i])
-			return 1;
-	return 0;
-}
-
-//Create children from crossover
-void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro){
+//Create children from crossover: a 30% segment of p stays in place, the other positions take m's cities in m's order
+void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro, unsigned char *visited, Rng *rng){
 	int z=1;
-	int n = getRandomNumber() % (chromo_length);
+	int n = getRandomNumber(rng) % (chromo_length);
 
-    #pragma omp parallel for num_threads(NUM_THRDS)
 	for(int i=0; i < chromo_length;i++)
 		Chro->genes[i] =0;
-        
-    //Parallelizing causes segmentation fault
+	memset(visited, 0, (chromo_length + 1) * sizeof(unsigned char));
+
 	for(int i = n; i < n+((chromo_length*30)/100);i++){
 		z=i%chromo_length;
 		Chro->genes[z]=p.genes[z];
+		visited[p.genes[z]] = 1;
 	}
 
+	//The empty positions are filled going around from the end of the segment
 	int c=0;
-	int i=(z+1) % chromo_length;
-	while(i!=z){
-		c = c%chromo_length;
-		if(if_exist(Chro, m.genes[c]) != 1)
-			Chro->genes[i] = m.genes[c];
-
-		else{
-			if(Chro->genes[i] == 0){
-				while(if_exist(Chro, m.genes[c]) == 1)
-					c++;
-				Chro->genes[i] = m.genes[c];
-			}
-		}
-		c++;
-		i++;
-		i = i % chromo_length;
+	for(int k = 1; k <= chromo_length; k++){
+		int i = (z + k) % chromo_length;
+		if(Chro->genes[i] != 0)
+			continue;
+		while(visited[m.genes[c]])
+			c++;
+		Chro->genes[i] = m.genes[c];
+		visited[m.genes[c]] = 1;
 	}
 }
 
-//used to perform crossover of two chromosomes
-void crossoverV2(Chromosome *pop){
+//used to perform crossover of two chromosomes (visited: the island's scratch map)
+void crossoverV2(Chromosome *pop, unsigned char *visited, Rng *rng){
 	int nb=0;
 	for(int i = 0; i < (popl_size/2) ; i++){
 		do{
-			nb= getRandomNumber() % (popl_size/2);
+			nb= getRandomNumber(rng) % (popl_size/2);
 		}while(nb == i && percentage_of_difference(pop[i], pop[nb]) < 70);
-		create_ChildV2(pop[i], pop[nb], &pop[(popl_size/2) +i]);
+		create_ChildV2(pop[i], pop[nb], &pop[(popl_size/2) +i], visited, rng);
 	}
 }
 
 //Used to perform mutation in a chromosome
-void mutation(Chromosome *pop){
+void mutation(Chromosome *pop, Rng *rng){
 	for(int z=0; z<5; z++){
-		int i = getRandomNumber()%(chromo_length);
-		int j = getRandomNumber()%(chromo_length);
-		int k = getRandomNumber()%(popl_size -(20*popl_size/100));
+		int i = getRandomNumber(rng)%(chromo_length);
+		int j = getRandomNumber(rng)%(chromo_length);
+		int k = getRandomNumber(rng)%(popl_size -(20*popl_size/100));
 		int temp = pop[(20*popl_size/100)+k].genes[j];
 		pop[(20*popl_size/100)+k].genes[j] = pop[(20*popl_size/100)+k].genes[i];
 		pop[(20*popl_size/100)+k].genes[i] = temp;
 	}
 }
 
+//Sends copies of the best chromosomes of the island to the next one
+void migrate_out(Island *island){
+    for(int m = 0; m < MIGRANTS; m++)
+        memcpy(&island->migrant_genes[m * chromo_length], island->population[m].genes, chromo_length * sizeof(int));
+}
+
+//Replaces the worst chromosomes of the island by the migrants of the previous one
+void migrate_in(Island *island, Island *from){
+    for(int m = 0; m < MIGRANTS; m++){
+        Chromosome *worst = &island->population[popl_size - 1 - m];
+        memcpy(worst->genes, &from->migrant_genes[m * chromo_length], chromo_length * sizeof(int));
+        calculate_fitness(worst);
+    }
+    sort_population(island->population);
+}
+
+//Allocates the island and fills it with random chromosomes, its generator is seeded from its index
+void init_island(Island *island, int index){
+    island->population = (Chromosome *)malloc(popl_size*sizeof(Chromosome));
+    island->migrant_genes = malloc(MIGRANTS * chromo_length * sizeof(int));
+    island->visited = malloc((chromo_length + 1) * sizeof(unsigned char));
+    rng_seed(&island->rng, ga_seed + index);
+
+    //Initialise chromosomes
+    for(int i = 0; i < popl_size ; i++)
+        fill_randomly_the_chromosome(&island->population[i], &island->rng);
+
+    sort_population(island->population); //Sort acc to fitness value
+}
+
+//Runs generations of the GA on the island alone
+void evolve_island(Island *island, int generations){
+    for(int i = 0; i < generations; i++){
+        selection(island->population, &island->rng); //Select 50% of population
+        crossoverV2(island->population, island->visited, &island->rng); //Perform the crossover
+        mutation(island->population, &island->rng); //Perform mutation
+        calculate_population_fitness(island->population); //Calculate new fitness value
+        sort_population(island->population); //Sort acc to fitness value
+    }
+}
+
 void main(int argc, char **argv){
 
-    //Initialising some constants
+    //Initialising some constants (the population size is per island)
     popl_size = 200;
     no_generation = 1000;
     parse_arguments(argc, argv);
     init_dist_matrix();
-    population = (Chromosome *)malloc(popl_size*sizeof(Chromosome));
-    
+    Island *islands = malloc(num_islands * sizeof(Island));
+
     //Start clock
     double start= omp_get_wtime();
 
-    //Initialise chromosomes
-    for(int i = 0; i < popl_size ; i++)
-        fill_randomly_the_chromosome(&population[i]);
-      
-    sort_population(population); //Sort acc to fitness value
-    //print_fitness();
-
-    int  i = 0;
-    while(i < no_generation){
-      selection(population); //Select 50% of population
-      crossoverV2(population); //Perform the crossover
-      mutation(population); //Perform mutation
-      calculate_population_fitness(population); //Calculate new fitness value
-      sort_population(population); //Sort acc to fitness value 
-      i++;
-      //print_fitness();
+    //The islands are shared out among the threads granted by OpenMP, which may be fewer than the islands.
+    //Between two migrations every island evolves on its own; the implicit barriers of the loops keep
+    //all the sends of a migration before its receives, and all the receives before the next generation
+    #pragma omp parallel num_threads(num_islands)
+    {
+        #pragma omp for schedule(static, 1)
+        for(int t = 0; t < num_islands; t++)
+            init_island(&islands[t], t);
+
+        for(int first = 0; first < no_generation; first += MIGRATION_INTERVAL){
+            int last = first + MIGRATION_INTERVAL < no_generation ? first + MIGRATION_INTERVAL : no_generation;
+            #pragma omp for schedule(static, 1)
+            for(int t = 0; t < num_islands; t++)
+                evolve_island(&islands[t], last - first);
+
+            //Ring migration after every MIGRATION_INTERVAL generations
+            if(num_islands > 1 && last % MIGRATION_INTERVAL == 0){
+                #pragma omp for schedule(static, 1)
+                for(int t = 0; t < num_islands; t++)
+                    migrate_out(&islands[t]);
+                #pragma omp for schedule(static, 1)
+                for(int t = 0; t < num_islands; t++)
+                    migrate_in(&islands[t], &islands[(t + num_islands - 1) % num_islands]);
+            }
+        }
     }
 
     double end= omp_get_wtime();
+
+    //Best chromosome of all the islands
+    Chromosome *best = &islands[0].population[0];
+    for(int t = 1; t < num_islands; t++)
+        if(islands[t].population[0].fitness > best->fitness)
+            best = &islands[t].population[0];
 #ifdef DEBUG
     printf("Time: \t %f \n", ((end-start)));
+    printf("Islands: %d, Best distance: %.2f, Children/s: %.0f\n", num_islands, tour_length(best),
+           (double)num_islands * (popl_size/2) * no_generation / (end-start));
 #endif
-    //print_population(population);
-}
\ No newline at end of file
+    //print_chromosome(best);
+}
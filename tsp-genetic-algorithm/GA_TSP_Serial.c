@@ -3,12 +3,19 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 
 int chromo_length; // Number of cities
 int popl_size; // Number of chromosomes
 int no_generation; //Number of iterations (Generations)
 float **dist_matrix; //Stores distance between cities
 char citiesNameFile[255]; //Stores all city names
+unsigned long long ga_seed; //Seed of the random number generator
+
+//Random number generator (xorshift128+) passed to the operators, runs are reproducible from the seed
+typedef struct{
+    uint64_t state[2];
+} Rng;
 
 typedef struct{ //Structure used to store a city id and coordinate
     int id;
@@ -23,6 +30,7 @@ typedef struct{
     float fitness;
 } Chromosome;
 Chromosome * population;
+unsigned char *visited; //Cities already placed in the child being built
 
 //Prints the fitness value and the path of a chromosome
 void print_chromosome(Chromosome *ptr_chromosome){
@@ -40,15 +48,38 @@ void print_population(Chromosome *population){
         print_chromosome(&population[i]);
 }
 
-//Accepts the input filename to extract cities' coordinates
+//Accepts the input filename to extract cities' coordinates, and the optional seed
 void parse_arguments(int argc, char **argv){
-    if (argc != 2){
-        printf("Must submit TSP locations test file name as argument.\n");
+    ga_seed = (unsigned long long)time(NULL);
+    if (argc == 4 && strcmp(argv[2], "--seed") == 0){
+        ga_seed = strtoull(argv[3], NULL, 10);
+    }
+    else if (argc != 2){
+        printf("Must submit TSP locations test file name as argument (and optionally --seed <n>).\n");
         exit(0);
-    } 
-    else{
-        strcpy(citiesNameFile, argv[1]);
     }
+    strcpy(citiesNameFile, argv[1]);
+}
+
+//Initializes the generator state from a seed (splitmix64)
+void rng_seed(Rng *rng, uint64_t seed){
+    for(int i = 0; i < 2; i++){
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        rng->state[i] = z ^ (z >> 31);
+    }
+}
+
+//Random int in [0, bound)
+int rng_int(Rng *rng, int bound){
+    uint64_t s1 = rng->state[0];
+    const uint64_t s0 = rng->state[1];
+    rng->state[0] = s0;
+    s1 ^= s1 << 23;
+    rng->state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return (int)((((rng->state[1] + s0) >> 32) * (uint64_t)bound) >> 32);
 }
 
 //Performs the file reading operation
@@ -134,15 +165,13 @@ void calculate_population_fitness(Chromosome *population){
         calculate_fitness(&population[i]);
 }
 
-//Generating a random number using seeds
-int getRandomNumber(){
-	int seed = (unsigned)(time(NULL)+rand());
-	srand(seed);
-	return rand()%chromo_length;
+//Generating a random city index
+int getRandomNumber(Rng *rng){
+	return rng_int(rng, chromo_length);
 }
 
 //Initialising the chromosome path or solution as random
-void fill_randomly_the_chromosome(Chromosome *chrom){
+void fill_randomly_the_chromosome(Chromosome *chrom, Rng *rng){
     
     int array[chromo_length];
     chrom->genes = malloc(chromo_length * sizeof (int));
@@ -151,7 +180,7 @@ void fill_randomly_the_chromosome(Chromosome *chrom){
         array[i] = i+1;
   
     for(int i = 0; i < chromo_length; i++){
-        int nbRand = getRandomNumber()%(chromo_length -i);
+        int nbRand = getRandomNumber(rng)%(chromo_length -i);
         int tmp = array[nbRand];
         array[nbRand] = array[chromo_length - i - 1];
         array[chromo_length - i - 1] = tmp;
@@ -167,26 +196,28 @@ void swap_chromosomes( Chromosome *pop, int src, int dest){
 	pop[dest] = chrom;
 }
 
-//Sorting population on the basis of fitness value
+//Orders chromosomes by descending fitness value (qsort comparator)
+int compare_fitness_desc(const void *a, const void *b){
+    float fa = ((const Chromosome *)a)->fitness;
+    float fb = ((const Chromosome *)b)->fitness;
+    return (fa < fb) - (fa > fb);
+}
+
+//Sorting population on the basis of fitness value in O(P log P)
 void sort_population(Chromosome *population){
-    for(int i = 0; i < popl_size; i++)
-        for(int j = i+1; j < popl_size; j++)
-            if(population[i].fitness <population[j].fitness)
-                swap_chromosomes(population, i, j);
+    qsort(population, popl_size, sizeof(Chromosome), compare_fitness_desc);
 }
 
 //Generate a random chromosome index to be used during crossover
-int get_random_index_of_chrom(){
-    int seed = (unsigned)(time(NULL)+rand());
-    srand(seed);
-    return rand()%popl_size;
+int get_random_index_of_chrom(Rng *rng){
+    return rng_int(rng, popl_size);
 }
 
 //Selecting some chromosomes for crossover
-void selection(Chromosome *pop){
+void selection(Chromosome *pop, Rng *rng){
     int n = (40*popl_size)/100;
     for(int i = 0; i < (10*popl_size)/100; i++){ //Swapping 10 chromosomes from the last 50% to the middle
-        int randNb =(popl_size/2) + get_random_index_of_chrom()%(popl_size/2);
+        int randNb =(popl_size/2) + get_random_index_of_chrom(rng)%(popl_size/2);
         swap_chromosomes(population, n+i, randNb);
     }
 }
@@ -210,63 +241,50 @@ float percentage_of_difference(Chromosome chro1, Chromosome chro2){
 	return (sum*100)/chromo_length;
 }
 
-//If a vertex exists in the chromosome
-int if_exist(Chromosome *chrom, int x){
-	for(int i=0; i<chromo_length; i++)
-		if(x == chrom->genes[i])
-			return 1;
-	return 0;
-}
-
-//Create children from crossover
-void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro){
+//Create children from crossover: a 30% segment of p stays in place, the other positions take m's cities in m's order
+void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro, Rng *rng){
 	int z=1;
-	int n = getRandomNumber()%(chromo_length);
+	int n = getRandomNumber(rng)%(chromo_length);
 
 	for(int i=0; i < chromo_length;i++)
 		Chro->genes[i] =0;
-        
+	memset(visited, 0, (chromo_length + 1) * sizeof(unsigned char));
+
 	for(int i = n; i < n+((chromo_length*30)/100);i++){
 		z=i%chromo_length;
 		Chro->genes[z]=p.genes[z];
+		visited[p.genes[z]] = 1;
 	}
+
+	//The empty positions are filled going around from the end of the segment
 	int c=0;
-	int i=(z+1)%chromo_length;
-	while(i!=z){
-		c = c%chromo_length;
-		if(if_exist(Chro, m.genes[c]) != 1)
-			Chro->genes[i] = m.genes[c];
-
-		else{
-			if(Chro->genes[i] == 0){
-				while(if_exist(Chro, m.genes[c]) == 1){
-					c++;
-				}
-				Chro->genes[i] = m.genes[c];
-			}
-		}
-		c++;
-		i++;
-		i=i%chromo_length;
+	for(int k = 1; k <= chromo_length; k++){
+		int i = (z + k) % chromo_length;
+		if(Chro->genes[i] != 0)
+			continue;
+		while(visited[m.genes[c]])
+			c++;
+		Chro->genes[i] = m.genes[c];
+		visited[m.genes[c]] = 1;
 	}
 }
 
 //used to perform crossover of two chromosomes
-void crossoverV2(Chromosome *pop){
+void crossoverV2(Chromosome *pop, Rng *rng){
 	int nb=0;
 	for(int i = 0; i < (popl_size/2) ; i++){
 		do{
-			nb= getRandomNumber() % (popl_size/2);
+			nb= getRandomNumber(rng) % (popl_size/2);
 		}while(nb == i && percentage_of_difference(pop[i], pop[nb]) < 70);
-		create_ChildV2(pop[i], pop[nb], &pop[(popl_size/2) +i]);
+		create_ChildV2(pop[i], pop[nb], &pop[(popl_size/2) +i], rng);
 	}
 }
 //Used to perform mutation in a chromosome
-void mutation(Chromosome *pop){
+void mutation(Chromosome *pop, Rng *rng){
 	for(int z=0; z<5; z++){
-		int i = getRandomNumber()%(chromo_length);
-		int j = getRandomNumber()%(chromo_length);
-		int k = getRandomNumber()%(popl_size -(20*popl_size/100));
+		int i = getRandomNumber(rng)%(chromo_length);
+		int j = getRandomNumber(rng)%(chromo_length);
+		int k = getRandomNumber(rng)%(popl_size -(20*popl_size/100));
 		int temp = pop[(20*popl_size/100)+k].genes[j];
 		pop[(20*popl_size/100)+k].genes[j] = pop[(20*popl_size/100)+k].genes[i];
 		pop[(20*popl_size/100)+k].genes[i] = temp;
@@ -281,6 +299,9 @@ void main(int argc, char **argv){
     parse_arguments(argc, argv);
     init_dist_matrix();
     population = (Chromosome *)malloc(popl_size*sizeof(Chromosome));
+    visited = malloc((chromo_length + 1) * sizeof(unsigned char));
+    Rng rng;
+    rng_seed(&rng, ga_seed);
 
     //Start clock
     clock_t t;
@@ -288,16 +309,16 @@ void main(int argc, char **argv){
 
     //Initialise chromosomes
     for(int i = 0; i < popl_size ; i++)
-        fill_randomly_the_chromosome(&population[i]);
+        fill_randomly_the_chromosome(&population[i], &rng);
       
     sort_population(population); //Sort acc to fitness value
     //print_fitness();
 
     int  i = 0;
     while(i < no_generation){
-      selection(population); //Select 50% of population
-      crossoverV2(population); //Perform the crossover
-      mutation(population); //Perform mutation
+      selection(population, &rng); //Select 50% of population
+      crossoverV2(population, &rng); //Perform the crossover
+      mutation(population, &rng); //Perform mutation
       calculate_population_fitness(population); //Calculate new fitness value
       sort_population(population); //Sort acc to fitness value 
       i++;
@@ -1,34 +1,130 @@
+#define _POSIX_C_SOURCE 200112L // posix_memalign, clock_gettime
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 #include <dirent.h>
 #include <sys/stat.h>
 
-#define MIN_NODES 5
-#define MAX_NODES 30
 #define BASE_WEIGHT 100.0  // Base edge weight
 #define WEIGHT_VARIATION 0.005  // 0.5% variation
-#define NUM_RUNS 3  // Number of runs per node count for averaging
 #define MAX_FILENAME 256
 #define MAX_INSTANCE_NAME 50
+#define GAP_TEXT 32 //Size of the text of a formatted gap or optimal distance
 #define INSTANCES_DIR "instances"
 #define RESULTS_DIR "results"
 #define MAX_INSTANCES 100
+#define MAX_LINE 256
+#define MATRIX_ALIGNMENT 64 // Rows of the distance matrix start on cache line boundaries
+#define MAX_MATRIX_BYTES ((size_t)256 << 20) // Coordinate instances with a larger matrix compute the distances on the fly
+#define GEO_PI 3.141592 // TSPLIB's value, the published GEO optima depend on it
+#define GEO_RADIUS 6378.388
+#define SETTINGS_FILE "ga_settings.ini" // Read at start if present, --config <file> reads another one
+#define MAX_PROFILES 16
 
 int chromo_length; // Number of cities
 int popl_size; // Number of chromosomes
 int no_generation; //Number of iterations (Generations)
-float **dist_matrix = NULL; //Stores distance between cities
+//Edge weight types: explicit matrices and the TSPLIB coordinate distances
+typedef enum {
+    WEIGHT_EXPLICIT,
+    WEIGHT_EUC_2D,
+    WEIGHT_CEIL_2D,
+    WEIGHT_ATT,
+    WEIGHT_GEO
+} WeightType;
+const char *weight_type_names[] = {"EXPLICIT", "EUC_2D", "CEIL_2D", "ATT", "GEO"};
+
+//Distances between the cities: one flat matrix with rows padded to `stride` floats, or the coordinates of
+//the cities when the matrix would exceed MAX_MATRIX_BYTES (matrix is NULL, every access computes the distance)
+typedef struct {
+    float *matrix;
+    size_t stride;
+    WeightType weight_type;
+    double *x; // GEO: latitude in radians
+    double *y; // GEO: longitude in radians
+} DistanceTable;
+
+DistanceTable dist_table = {0}; //Distances of the graph being solved, owned by its instance or by random_table
+DistanceTable random_table = {0}; //Distances of the current random graph
+unsigned long long ga_seed; //Seed of all the runs, from --seed or the clock
+
+//Random number generator (xorshift128+) passed to every operator, so runs are reproducible from the seed
+typedef struct{
+    uint64_t state[2];
+} Rng;
 
-//Structures stores genes (sequence of cities) for a chromosome, and its fitness value
+//Structures stores genes (sequence of cities) for a chromosome, its tour length and fitness value.
+//The genes are a row of the current gene buffer; sorting and selection only move these small structs
 typedef struct{
     int * genes;
     float fitness;
+    double tour_length; // Kept in double as mutations update it by deltas
+    int dirty; // Genes changed since the last full evaluation, fitness is stale
+    int local_optimum; // No local search move improves the tour (memetic mode)
 } Chromosome;
 Chromosome * population = NULL;
 
+//Genes of the whole population: popl_size rows of chromo_length cities, one buffer holds the current generation,
+//the next generation is written into the other one
+int *gene_buffers[2] = {NULL, NULL};
+int current_buffer = 0;
+
+//Crossover operators selectable with -c
+typedef enum {
+    CROSSOVER_V2,
+    CROSSOVER_OX,
+    CROSSOVER_PMX,
+    CROSSOVER_ERX
+} CrossoverOperator;
+const char *crossover_names[] = {"v2", "ox", "pmx", "erx"};
+CrossoverOperator crossover_operator = CROSSOVER_V2;
+
+//Working memory of the crossover operators, allocated with the population (cities are 1-based)
+unsigned char *crossover_visited = NULL; //Cities already placed in the child
+int *crossover_position = NULL; //Position of each city in a parent (PMX), in the unvisited list (ERX)
+int *crossover_edges = NULL; //Up to 4 neighbours per city (ERX)
+int *crossover_edge_count = NULL;
+int *crossover_unvisited = NULL; //Cities not yet placed (ERX)
+
+//Memetic mode: local search on offspring and on the elite, enabled with --memetic <probability>
+#define NEIGHBOURS 8 //Nearest cities tried by the local search moves
+float memetic_probability = 0.0f; //Probability of improving a child by local search
+int memetic_ms = 20; //Local search time per generation [ms]
+int symmetric_matrix = 1; //2-opt reverses tour parts, so it is only used on symmetric instances
+int *neighbour_lists = NULL; //NEIGHBOURS cities c nearest to every city a by d(c, a), nearest first
+int *ls_position = NULL; //Position of every city in the tour being improved
+int *ls_queue = NULL; //Cities whose don't-look bit is off, in a ring buffer
+unsigned char *ls_in_queue = NULL;
+
+//Online convergence detection: a run has converged when its best fitness has not improved for STALL_WINDOW
+//generations and the EWMA of the improvements is negligible. The EWMA starts at 0, so the window decides
+//unless the run improved quickly just before it. A population that has lost its diversity is restarted
+//earlier (restart mode)
+#define STALL_WINDOW 50
+#define STALL_EWMA 1e-3 //Average relative improvement of the best fitness per generation
+#define STALL_DIVERSITY 0.01 //Share of the best tour's edges missing in the other chromosomes
+#define DIVERSITY_SAMPLES 8
+typedef enum {
+    STALL_STOP, //End the run
+    STALL_RESTART, //Replace the worse half of the population by random chromosomes, then go on
+    STALL_IGNORE //Always run all the generations
+} StallAction;
+const char *stall_action_names[] = {"stop", "restart", "none"};
+StallAction stall_action = STALL_STOP;
+int *diversity_successor = NULL; //Successor of every city in a sampled chromosome
+
+typedef struct {
+    float best_fitness;
+    double improvement_ewma;
+    int last_improvement; //Generation of the last improvement of the best fitness
+    float diversity;
+    Rng rng; //Draws the sampled chromosomes, apart from the run's generator so that detection does not change the run
+} ConvergenceMonitor;
+
 // Structure to store results for each test
 typedef struct {
     char instance_name[MAX_INSTANCE_NAME];
@@ -38,18 +134,52 @@ typedef struct {
     float best_distance;
     float best_fitness;
     int generations_to_converge;
-    float optimal_distance;  // Known optimal from file
-    float gap_percentage;    // Gap from optimal
+    int generations;         // Generations run, fewer than planned if stopped at convergence
+    float optimal_distance;  // Known optimal from file, -1 if unknown
+    float gap_percentage;    // Gap from optimal, 0 if the optimal is unknown
+    double children_per_sec; // Crossover throughput
 } TestResult;
 
 // Structure to store instance data
 typedef struct {
     char name[MAX_INSTANCE_NAME];
     int num_nodes;
-    float **matrix;
+    DistanceTable distances;
     float optimal_value;
+    int optimum_known;    // 0 for a TSPLIB instance without an OPTIMUM entry
 } InstanceData;
 
+// Population size and generations of the runs on graphs of up to max_nodes cities
+typedef struct {
+    int max_nodes;
+    int population;
+    int generations;
+} Profile;
+
+// Run parameters: the built-in defaults, replaced by the settings file, then by the command line
+typedef struct {
+    int min_nodes;          // Random graph sizes of the batch mode
+    int max_nodes;
+    int num_runs;           // Runs per node count (batch mode) and per instance (instance mode)
+    long max_exec_time_ms;  // Wall-clock budget of a run, replaces the generation count (0: no budget)
+    int population;         // Overrides the profiles (0: from the profile)
+    int generations;
+    Profile instance_profiles[MAX_PROFILES]; // Ordered by max_nodes, the first one covering the graph is used
+    int instance_profile_count;
+    Profile random_profiles[MAX_PROFILES];
+    int random_profile_count;
+} Settings;
+
+Settings settings = {
+    .min_nodes = 5,
+    .max_nodes = 30,
+    .num_runs = 3,
+    .instance_profiles = {{8, 50, 300}, {12, 75, 400}, {16, 100, 500}, {25, 150, 600}, {INT_MAX, 200, 800}},
+    .instance_profile_count = 5,
+    .random_profiles = {{8, 50, 300}, {12, 75, 400}, {16, 100, 500}, {INT_MAX, 150, 600}},
+    .random_profile_count = 4
+};
+
 //Create results directory if it doesn't exist
 void create_results_directory() {
     struct stat st = {0};
@@ -114,86 +244,138 @@ int get_instance_files(char filenames[][MAX_FILENAME], int max_files) {
 #endif
     return count;
 }
-float random_float() {
-    return (float)rand() / RAND_MAX;
+//Initializes the generator state from a seed (splitmix64)
+void rng_seed(Rng *rng, uint64_t seed) {
+    for(int i = 0; i < 2; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        rng->state[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t rng_next(Rng *rng) {
+    uint64_t s1 = rng->state[0];
+    const uint64_t s0 = rng->state[1];
+    rng->state[0] = s0;
+    s1 ^= s1 << 23;
+    rng->state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return rng->state[1] + s0;
+}
+
+//Random int in [0, bound)
+int rng_int(Rng *rng, int bound) {
+    return (int)(((rng_next(rng) >> 32) * (uint64_t)bound) >> 32);
+}
+
+//Random float in [0, 1)
+float random_float(Rng *rng) {
+    return (rng_next(rng) >> 40) * (1.0f / 16777216.0f);
 }
 
 //Generate random edge weight with 0.5% variation
-float generate_random_weight() {
-    float variation = (random_float() - 0.5f) * 2.0f * WEIGHT_VARIATION; // -0.5% to +0.5%
+float generate_random_weight(Rng *rng) {
+    float variation = (random_float(rng) - 0.5f) * 2.0f * WEIGHT_VARIATION; // -0.5% to +0.5%
     return BASE_WEIGHT * (1.0f + variation);
 }
 
-//Clean up distance matrix
-void cleanup_dist_matrix() {
-    if(dist_matrix) {
-        for(int i = 0; i < chromo_length; i++) {
-            if(dist_matrix[i]) {
-                free(dist_matrix[i]);
-                dist_matrix[i] = NULL;
-            }
+//TSPLIB distance between cities i and j (0-based) computed from their coordinates
+float coordinate_distance(const DistanceTable *table, int i, int j) {
+    double dx = table->x[i] - table->x[j];
+    double dy = table->y[i] - table->y[j];
+    switch(table->weight_type) {
+        case WEIGHT_CEIL_2D:
+            return (float)ceil(sqrt(dx * dx + dy * dy));
+        case WEIGHT_ATT: {
+            double r = sqrt((dx * dx + dy * dy) / 10.0);
+            double t = floor(r + 0.5);
+            return (float)(t < r ? t + 1.0 : t);
+        }
+        case WEIGHT_GEO: {
+            double q1 = cos(dy);
+            double q2 = cos(dx);
+            double q3 = cos(table->x[i] + table->x[j]);
+            double c = 0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3);
+            return (float)(int)(GEO_RADIUS * acos(c < 1.0 ? c : 1.0) + 1.0);
         }
-        free(dist_matrix);
-        dist_matrix = NULL;
+        default:
+            return (float)floor(sqrt(dx * dx + dy * dy) + 0.5);
     }
 }
 
-//Clean up instance data
-void cleanup_instance_data(InstanceData *instance) {
-    if(instance && instance->matrix) {
-        for(int i = 0; i < instance->num_nodes; i++) {
-            if(instance->matrix[i]) {
-                free(instance->matrix[i]);
-            }
-        }
-        free(instance->matrix);
-        instance->matrix = NULL;
-    }
+//Distance between cities i and j (0-based) of the graph being solved
+static inline float distance(int i, int j) {
+    if(dist_table.matrix)
+        return dist_table.matrix[i * dist_table.stride + j];
+    return coordinate_distance(&dist_table, i, j);
 }
 
-//Read instance from file
-int read_instance_file(const char* filename, InstanceData* instance) {
-    FILE *fp = fopen(filename, "r");
-    if(!fp) {
-        printf("Error: Cannot open file %s\n", filename);
+//Allocates the n x n matrix of a table with aligned, padded rows
+int alloc_distance_matrix(DistanceTable *table, int n) {
+    void *matrix = NULL;
+    table->stride = ((size_t)n + 15) & ~(size_t)15; // Whole cache lines of 16 floats
+    if(posix_memalign(&matrix, MATRIX_ALIGNMENT, (size_t)n * table->stride * sizeof(float)) != 0)
         return 0;
+    table->matrix = matrix;
+    return 1;
+}
+
+//Frees the matrix and coordinates of a table
+void free_distance_table(DistanceTable *table) {
+    free(table->matrix);
+    free(table->x);
+    free(table->y);
+    memset(table, 0, sizeof(DistanceTable));
+}
+
+//Clean up distance matrix
+void cleanup_dist_matrix() {
+    free_distance_table(&random_table);
+    memset(&dist_table, 0, sizeof(DistanceTable));
+}
+
+//Clean up instance data
+void cleanup_instance_data(InstanceData *instance) {
+    if(instance) {
+        free_distance_table(&instance->distances);
     }
+}
 
+//Read an explicit matrix instance: name, number of nodes, full distance matrix, optimal value
+int read_matrix_instance(FILE *fp, InstanceData* instance) {
     // Read instance name
     if(fscanf(fp, "%49s", instance->name) != 1) {
         printf("Error: Cannot read instance name\n");
-        fclose(fp);
         return 0;
     }
 
     // Read number of nodes
     if(fscanf(fp, "%d", &instance->num_nodes) != 1) {
         printf("Error: Cannot read number of nodes\n");
-        fclose(fp);
         return 0;
     }
 
-    if(instance->num_nodes <= 0 || instance->num_nodes > 1000) {
+    if(instance->num_nodes <= 0) {
         printf("Error: Invalid number of nodes: %d\n", instance->num_nodes);
-        fclose(fp);
         return 0;
     }
 
     // Allocate matrix
-    instance->matrix = malloc(sizeof(float*) * instance->num_nodes);
-    for(int i = 0; i < instance->num_nodes; i++) {
-        instance->matrix[i] = malloc(sizeof(float) * instance->num_nodes);
+    DistanceTable *table = &instance->distances;
+    table->weight_type = WEIGHT_EXPLICIT;
+    if(!alloc_distance_matrix(table, instance->num_nodes)) {
+        printf("Error: Not enough memory for %d nodes\n", instance->num_nodes);
+        return 0;
     }
 
     // Read distance matrix
     for(int i = 0; i < instance->num_nodes; i++) {
         for(int j = 0; j < instance->num_nodes; j++) {
-            if(fscanf(fp, "%f", &instance->matrix[i][j]) != 1) {
+            if(fscanf(fp, "%f", &table->matrix[i * table->stride + j]) != 1) {
 #ifdef DEBUG
                 printf("Error: Cannot read matrix element [%d][%d]\n", i, j);
 #endif
-                cleanup_instance_data(instance);
-                fclose(fp);
                 return 0;
             }
         }
@@ -202,60 +384,221 @@ int read_instance_file(const char* filename, InstanceData* instance) {
     // Read optimal value
     if(fscanf(fp, "%f", &instance->optimal_value) != 1) {
         printf("Error: Cannot read optimal value\n");
-        cleanup_instance_data(instance);
-        fclose(fp);
+        return 0;
+    }
+    instance->optimum_known = 1;
+    return 1;
+}
+
+//TSPLIB GEO coordinate (DDD.MM, degrees and minutes) in radians
+double geo_radians(double value) {
+    double degrees = (int)value;
+    return GEO_PI * (degrees + 5.0 * (value - degrees) / 3.0) / 180.0;
+}
+
+//Read the cities of a NODE_COORD_SECTION; the matrix is computed if it fits in MAX_MATRIX_BYTES
+int read_node_coordinates(FILE *fp, InstanceData* instance) {
+    DistanceTable *table = &instance->distances;
+    int n = instance->num_nodes;
+    table->x = malloc(n * sizeof(double));
+    table->y = malloc(n * sizeof(double));
+    unsigned char *seen = calloc(n, sizeof(unsigned char)); //Every node id must appear exactly once
+    if(!table->x || !table->y || !seen) {
+        printf("Error: Not enough memory for %d nodes\n", n);
+        free(seen);
+        return 0;
+    }
+
+    for(int k = 0; k < n; k++) {
+        int city;
+        double x, y;
+        if(fscanf(fp, "%d %lf %lf", &city, &x, &y) != 3 || city < 1 || city > n) {
+            printf("Error: Invalid coordinates of node %d\n", k + 1);
+            free(seen);
+            return 0;
+        }
+        if(seen[city - 1]) {
+            printf("Error: Duplicate node %d in NODE_COORD_SECTION\n", city);
+            free(seen);
+            return 0;
+        }
+        seen[city - 1] = 1;
+        table->x[city - 1] = table->weight_type == WEIGHT_GEO ? geo_radians(x) : x;
+        table->y[city - 1] = table->weight_type == WEIGHT_GEO ? geo_radians(y) : y;
+    }
+    free(seen);
+
+    if((size_t)n * n * sizeof(float) > MAX_MATRIX_BYTES)
+        return 1;
+    if(!alloc_distance_matrix(table, n)) {
+        printf("Error: Not enough memory for %d nodes\n", n);
+        return 0;
+    }
+    for(int i = 0; i < n; i++)
+        for(int j = 0; j < n; j++)
+            table->matrix[i * table->stride + j] = i == j ? 0.0f : coordinate_distance(table, i, j);
+    free(table->x);
+    free(table->y);
+    table->x = table->y = NULL;
+    return 1;
+}
+
+//Triangular EDGE_WEIGHT_FORMATs, read row by row: the weights (i, j) with j > i (upper) or j < i, and
+//(i, i) for a DIAG format. A column format lists the weights of a triangle in the order of the row
+//format of the other triangle, and the matrix is symmetric, so it is read as that row format
+const struct {
+    const char *name;
+    int upper;
+    int diagonal;
+} triangle_formats[] = {
+    {"UPPER_ROW", 1, 0}, {"LOWER_ROW", 0, 0}, {"UPPER_DIAG_ROW", 1, 1}, {"LOWER_DIAG_ROW", 0, 1},
+    {"UPPER_COL", 0, 0}, {"LOWER_COL", 1, 0}, {"UPPER_DIAG_COL", 0, 1}, {"LOWER_DIAG_COL", 1, 1}
+};
+
+//Read the EDGE_WEIGHT_SECTION of an explicit TSPLIB instance in one of its matrix formats
+int read_edge_weights(FILE *fp, InstanceData* instance, const char *format) {
+    DistanceTable *table = &instance->distances;
+    int n = instance->num_nodes;
+    int full = strcmp(format, "FULL_MATRIX") == 0;
+    int upper = 0, diagonal = 0, known = full;
+    for(size_t f = 0; !known && f < sizeof(triangle_formats) / sizeof(triangle_formats[0]); f++) {
+        if(strcmp(format, triangle_formats[f].name) == 0) {
+            upper = triangle_formats[f].upper;
+            diagonal = triangle_formats[f].diagonal;
+            known = 1;
+        }
+    }
+    if(!known) {
+        printf("Error: Unsupported EDGE_WEIGHT_FORMAT: %s\n", format);
+        return 0;
+    }
+    if(!alloc_distance_matrix(table, n)) {
+        printf("Error: Not enough memory for %d nodes\n", n);
+        return 0;
+    }
+
+    for(int i = 0; i < n; i++) {
+        table->matrix[i * table->stride + i] = 0.0f;
+        for(int j = 0; j < n; j++) {
+            if(!full && (i == j ? !diagonal : (upper ? j < i : j > i)))
+                continue;
+            float weight;
+            if(fscanf(fp, "%f", &weight) != 1) {
+                printf("Error: Cannot read edge weight [%d][%d]\n", i, j);
+                return 0;
+            }
+            table->matrix[i * table->stride + j] = weight;
+            if(!full)
+                table->matrix[j * table->stride + i] = weight;
+        }
+    }
+    return 1;
+}
+
+//Read a TSPLIB instance (EXPLICIT, EUC_2D, CEIL_2D, ATT or GEO); an OPTIMUM entry gives the optimal value
+int read_tsplib_instance(FILE *fp, InstanceData* instance) {
+    char line[MAX_LINE];
+    char format[MAX_LINE] = "FULL_MATRIX";
+    instance->distances.weight_type = WEIGHT_EXPLICIT;
+
+    while(fgets(line, sizeof(line), fp)) {
+        char key[MAX_LINE], value[MAX_LINE] = "";
+        char *colon = strchr(line, ':');
+        if(colon)
+            *colon = ' ';
+        if(sscanf(line, "%255s %255s", key, value) < 1)
+            continue;
+
+        if(strcmp(key, "NAME") == 0) {
+            snprintf(instance->name, MAX_INSTANCE_NAME, "%.*s", MAX_INSTANCE_NAME - 1, value);
+        } else if(strcmp(key, "DIMENSION") == 0) {
+            instance->num_nodes = atoi(value);
+            if(instance->num_nodes <= 0) {
+                printf("Error: Invalid number of nodes: %s\n", value);
+                return 0;
+            }
+        } else if(strcmp(key, "EDGE_WEIGHT_TYPE") == 0) {
+            int type = WEIGHT_EXPLICIT;
+            while(type <= WEIGHT_GEO && strcmp(value, weight_type_names[type]) != 0)
+                type++;
+            if(type > WEIGHT_GEO) {
+                printf("Error: Unsupported EDGE_WEIGHT_TYPE: %s\n", value);
+                return 0;
+            }
+            instance->distances.weight_type = (WeightType)type;
+        } else if(strcmp(key, "EDGE_WEIGHT_FORMAT") == 0) {
+            strcpy(format, value);
+        } else if(strcmp(key, "OPTIMUM") == 0) {
+            instance->optimal_value = (float)atof(value);
+            instance->optimum_known = 1;
+        } else if(strcmp(key, "NODE_COORD_SECTION") == 0 || strcmp(key, "EDGE_WEIGHT_SECTION") == 0) {
+            int coordinates = key[0] == 'N';
+            if(instance->num_nodes <= 0) {
+                printf("Error: %s before DIMENSION\n", key);
+                return 0;
+            }
+            if(coordinates != (instance->distances.weight_type != WEIGHT_EXPLICIT)) {
+                printf("Error: %s does not match EDGE_WEIGHT_TYPE %s\n", key,
+                       weight_type_names[instance->distances.weight_type]);
+                return 0;
+            }
+            return coordinates ? read_node_coordinates(fp, instance) : read_edge_weights(fp, instance, format);
+        }
+    }
+    printf("Error: No NODE_COORD_SECTION or EDGE_WEIGHT_SECTION\n");
+    return 0;
+}
+
+//Read instance from file, either an explicit matrix or a TSPLIB file (recognized by its "KEY : value" header)
+int read_instance_file(const char* filename, InstanceData* instance) {
+    FILE *fp = fopen(filename, "r");
+    if(!fp) {
+        printf("Error: Cannot open file %s\n", filename);
         return 0;
     }
 
+    char line[MAX_LINE] = "";
+    int tsplib = fgets(line, sizeof(line), fp) && strchr(line, ':');
+    rewind(fp);
+    int read = tsplib ? read_tsplib_instance(fp, instance) : read_matrix_instance(fp, instance);
     fclose(fp);
+    if(!read) {
+        cleanup_instance_data(instance);
+        return 0;
+    }
 #ifdef DEBUG
-    printf("Successfully loaded instance: %s (%d nodes, optimal: %.0f)\n",
-           instance->name, instance->num_nodes, instance->optimal_value);
+    printf("Successfully loaded instance: %s (%d nodes, %s, optimal: %.0f)\n",
+           instance->name, instance->num_nodes, weight_type_names[instance->distances.weight_type],
+           instance->optimal_value);
 #endif
     return 1;
 }
 
 //Initialize distance matrix with random weights
-void init_random_dist_matrix(int num_nodes){
+void init_random_dist_matrix(int num_nodes, Rng *rng){
     // Clean up previous matrix
     cleanup_dist_matrix();
 
     chromo_length = num_nodes;
-    dist_matrix = malloc(sizeof(float *) * chromo_length);
-
-    // Allocate memory for each row
-    for (int i = 0; i < chromo_length; i++) {
-        dist_matrix[i] = calloc(chromo_length, sizeof(float));
-    }
+    alloc_distance_matrix(&random_table, chromo_length);
+    float *matrix = random_table.matrix;
+    size_t stride = random_table.stride;
 
     // Generate random distances
     for (int i = 0; i < chromo_length; i++){
         for (int j = i + 1; j < chromo_length; j++){
-            float weight = generate_random_weight();
-            dist_matrix[i][j] = dist_matrix[j][i] = weight;
+            float weight = generate_random_weight(rng);
+            matrix[i * stride + j] = matrix[j * stride + i] = weight;
         }
-        dist_matrix[i][i] = 0.0f; // Distance from node to itself is 0
+        matrix[i * stride + i] = 0.0f; // Distance from node to itself is 0
     }
+    dist_table = random_table;
 }
 
-//Initialize distance matrix from instance data
+//Use the distances of an instance; they stay owned by the instance, so the runs do not copy them
 void init_dist_matrix_from_instance(InstanceData* instance) {
-    cleanup_dist_matrix();
-
     chromo_length = instance->num_nodes;
-    dist_matrix = malloc(sizeof(float *) * chromo_length);
-
-    // Allocate memory for each row
-    for (int i = 0; i < chromo_length; i++) {
-        dist_matrix[i] = malloc(sizeof(float) * chromo_length);
-    }
-
-    // Copy matrix from instance
-    for (int i = 0; i < chromo_length; i++) {
-        for (int j = 0; j < chromo_length; j++) {
-            dist_matrix[i][j] = instance->matrix[i][j];
-        }
-    }
+    dist_table = instance->distances;
 }
 
 //Print distance matrix (for debugging small instances)
@@ -270,7 +613,7 @@ void print_dist_matrix() {
     for (int i = 0; i < chromo_length; i++){
         printf("%2d | ", i + 1);
         for (int j = 0; j < chromo_length; j++)
-            printf("%8.0f ", dist_matrix[i][j]);
+            printf("%8.0f ", distance(i, j));
         printf("\n");
     }
     printf("\n");
@@ -279,63 +622,91 @@ void print_dist_matrix() {
 
 //Calculates fitness value for each chromosome
 void calculate_fitness(Chromosome *ptr_chromosome){
-    float fitness = 0;
+    double length = 0;
     int i = 0;
 
     for (i = 0; i < chromo_length-1; i++)
-        fitness += dist_matrix[ptr_chromosome->genes[i] - 1][ptr_chromosome->genes[i+1] - 1];
+        length += distance(ptr_chromosome->genes[i] - 1, ptr_chromosome->genes[i+1] - 1);
 
-    fitness += dist_matrix[ptr_chromosome->genes[i] - 1][0]; // Return to start
-    fitness = 10000.0f / fitness; // Higher fitness for shorter paths
-    ptr_chromosome->fitness = fitness;
+    length += distance(ptr_chromosome->genes[i] - 1, ptr_chromosome->genes[0] - 1); // Return to start
+    ptr_chromosome->tour_length = length;
+    ptr_chromosome->fitness = 10000.0f / length; // Higher fitness for shorter paths
+    ptr_chromosome->dirty = 0;
 }
 
-//Send each chromosome to the above function
+//Evaluates only the chromosomes changed since their last evaluation
 void calculate_population_fitness(Chromosome *population){
     for(int i = 0; i < popl_size; i++)
-        calculate_fitness(&population[i]);
+        if(population[i].dirty)
+            calculate_fitness(&population[i]);
 }
 
-//Generating a random number
-int getRandomNumber(){
-    return rand() % chromo_length;
+//Sum of the tour edges (genes[k], genes[k+1]) for the given edge indices k
+double sum_of_edges(int *genes, int *edges, int count){
+    double length = 0;
+    for(int e = 0; e < count; e++)
+        length += distance(genes[edges[e]] - 1, genes[(edges[e] + 1) % chromo_length] - 1);
+    return length;
 }
 
-//Clean up a single chromosome
-void cleanup_chromosome(Chromosome *chrom) {
-    if(chrom && chrom->genes) {
-        free(chrom->genes);
-        chrom->genes = NULL;
+//Swaps the genes at positions i and j, updating the fitness in O(1) instead of re-evaluating the whole tour
+void swap_genes(Chromosome *chrom, int i, int j){
+    int *genes = chrom->genes;
+    int temp;
+    if(i == j)
+        return;
+    if(chrom->dirty){ //Evaluated in full later anyway
+        temp = genes[i];
+        genes[i] = genes[j];
+        genes[j] = temp;
+        return;
     }
-}
 
-//Initialising the chromosome path or solution as random
-void fill_randomly_the_chromosome(Chromosome *chrom){
-    int *array = malloc(chromo_length * sizeof(int));
+    //Only the edges entering and leaving both positions change; neighbouring positions share an edge
+    int candidates[4] = {(i + chromo_length - 1) % chromo_length, i, (j + chromo_length - 1) % chromo_length, j};
+    int edges[4];
+    int count = 0;
+    for(int c = 0; c < 4; c++){
+        int seen = 0;
+        for(int e = 0; e < count; e++)
+            if(edges[e] == candidates[c])
+                seen = 1;
+        if(!seen)
+            edges[count++] = candidates[c];
+    }
+
+    double removed = sum_of_edges(genes, edges, count);
+    temp = genes[i];
+    genes[i] = genes[j];
+    genes[j] = temp;
+    double added = sum_of_edges(genes, edges, count);
 
-    // Clean up existing genes
-    cleanup_chromosome(chrom);
+    chrom->tour_length += added - removed;
+    chrom->fitness = 10000.0f / chrom->tour_length;
+    chrom->local_optimum = 0;
+}
+
+//Generating a random number
+int getRandomNumber(Rng *rng){
+    return rng_int(rng, chromo_length);
+}
 
-    chrom->genes = malloc(chromo_length * sizeof(int));
+//Initialising the chromosome path or solution as random (in its row of the gene buffer)
+void fill_randomly_the_chromosome(Chromosome *chrom, Rng *rng){
+    int *genes = chrom->genes;
 
-    //Initialize array with node numbers (1-based)
+    //Initialize genes with node numbers (1-based)
     for(int i = 0; i < chromo_length; i++)
-        array[i] = i + 1;
+        genes[i] = i + 1;
 
     //Fisher-Yates shuffle
     for(int i = chromo_length - 1; i > 0; i--){
-        int j = rand() % (i + 1);
-        int tmp = array[i];
-        array[i] = array[j];
-        array[j] = tmp;
-    }
-
-    // Copy shuffled array to genes
-    for(int i = 0; i < chromo_length; i++) {
-        chrom->genes[i] = array[i];
+        int j = rng_int(rng, i + 1);
+        int tmp = genes[i];
+        genes[i] = genes[j];
+        genes[j] = tmp;
     }
 
-    free(array);
     calculate_fitness(chrom);
 }
 
@@ -346,24 +717,28 @@ void swap_chromosomes(Chromosome *pop, int src, int dest){
     pop[dest] = chrom;
 }
 
-//Sorting population on the basis of fitness value (descending order)
+//Orders chromosomes by descending fitness value (qsort comparator)
+int compare_fitness_desc(const void *a, const void *b){
+    float fa = ((const Chromosome *)a)->fitness;
+    float fb = ((const Chromosome *)b)->fitness;
+    return (fa < fb) - (fa > fb);
+}
+
+//Sorting population on the basis of fitness value (descending order) in O(P log P)
 void sort_population(Chromosome *population){
-    for(int i = 0; i < popl_size; i++)
-        for(int j = i+1; j < popl_size; j++)
-            if(population[i].fitness < population[j].fitness)
-                swap_chromosomes(population, i, j);
+    qsort(population, popl_size, sizeof(Chromosome), compare_fitness_desc);
 }
 
 //Generate a random chromosome index to be used during crossover
-int get_random_index_of_chrom(){
-    return rand() % popl_size;
+int get_random_index_of_chrom(Rng *rng){
+    return rng_int(rng, popl_size);
 }
 
 //Selecting some chromosomes for crossover
-void selection(Chromosome *pop){
+void selection(Chromosome *pop, Rng *rng){
     int n = (40 * popl_size) / 100;
     for(int i = 0; i < (10 * popl_size) / 100; i++){
-        int randNb = (popl_size / 2) + get_random_index_of_chrom() % (popl_size / 2);
+        int randNb = (popl_size / 2) + get_random_index_of_chrom(rng) % (popl_size / 2);
         swap_chromosomes(population, n + i, randNb);
     }
 }
@@ -377,22 +752,28 @@ float percentage_of_difference(Chromosome chro1, Chromosome chro2){
     return (sum * 100) / chromo_length;
 }
 
-//If a vertex exists in the chromosome
-int if_exist(Chromosome *chrom, int x){
-    for(int i = 0; i < chromo_length; i++)
-        if(x == chrom->genes[i])
-            return 1;
-    return 0;
+//Marks a city as placed in the child being built
+void mark_visited(int city){
+    crossover_visited[city] = 1;
+}
+
+//Starts a new child: no city placed yet
+void clear_visited(){
+    memset(crossover_visited, 0, (chromo_length + 1) * sizeof(unsigned char));
 }
 
-//Create children from crossover
-void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro){
-    // Clean up existing genes
-    cleanup_chromosome(Chro);
+//Starts a child, its genes already point to its row of the next generation's buffer
+void prepare_child(Chromosome *Chro){
+    Chro->dirty = 1;
+    Chro->local_optimum = 0;
+    clear_visited();
+}
 
-    Chro->genes = malloc(chromo_length * sizeof(int));
+//Create children from crossover: a 30% segment of p stays in place, the other positions take m's cities in m's order
+void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro, Rng *rng){
+    prepare_child(Chro);
     int z = 1;
-    int n = getRandomNumber() % chromo_length;
+    int n = getRandomNumber(rng) % chromo_length;
 
     for(int i = 0; i < chromo_length; i++)
         Chro->genes[i] = 0;
@@ -400,86 +781,571 @@ void create_ChildV2(Chromosome p, Chromosome m, Chromosome *Chro){
     for(int i = n; i < n + ((chromo_length * 30) / 100); i++){
         z = i % chromo_length;
         Chro->genes[z] = p.genes[z];
+        mark_visited(p.genes[z]);
     }
 
+    //The empty positions are filled going around from the end of the segment
     int c = 0;
-    int i = (z + 1) % chromo_length;
-    while(i != z){
-        c = c % chromo_length;
-        if(if_exist(Chro, m.genes[c]) != 1)
-            Chro->genes[i] = m.genes[c];
-        else{
-            if(Chro->genes[i] == 0){
-                while(if_exist(Chro, m.genes[c]) == 1)
-                    c++;
-                Chro->genes[i] = m.genes[c];
-            }
+    for(int k = 1; k <= chromo_length; k++){
+        int i = (z + k) % chromo_length;
+        if(Chro->genes[i] != 0)
+            continue;
+        while(crossover_visited[m.genes[c]])
+            c++;
+        Chro->genes[i] = m.genes[c];
+        mark_visited(m.genes[c]);
+    }
+}
+
+//Picks a random segment [*first, *last] of the chromosome
+void random_segment(int *first, int *last, Rng *rng){
+    *first = getRandomNumber(rng) % chromo_length;
+    *last = getRandomNumber(rng) % chromo_length;
+    if(*first > *last){
+        int temp = *first;
+        *first = *last;
+        *last = temp;
+    }
+}
+
+//Order crossover (OX): p's segment stays in place, the rest follows m's order starting after the segment
+void create_child_ox(Chromosome p, Chromosome m, Chromosome *Chro, Rng *rng){
+    int first, last;
+    prepare_child(Chro);
+    random_segment(&first, &last, rng);
+
+    for(int i = first; i <= last; i++){
+        Chro->genes[i] = p.genes[i];
+        mark_visited(p.genes[i]);
+    }
+
+    int i = (last + 1) % chromo_length;
+    for(int k = 1; k <= chromo_length; k++){
+        int city = m.genes[(last + k) % chromo_length];
+        if(crossover_visited[city])
+            continue;
+        Chro->genes[i] = city;
+        mark_visited(city);
+        i = (i + 1) % chromo_length;
+    }
+}
+
+//Partially mapped crossover (PMX): p's segment stays in place, m's cities displaced by it follow the mapping
+void create_child_pmx(Chromosome p, Chromosome m, Chromosome *Chro, Rng *rng){
+    int first, last;
+    prepare_child(Chro);
+    random_segment(&first, &last, rng);
+
+    for(int i = 0; i < chromo_length; i++){
+        Chro->genes[i] = 0;
+        crossover_position[m.genes[i]] = i;
+    }
+    for(int i = first; i <= last; i++){
+        Chro->genes[i] = p.genes[i];
+        mark_visited(p.genes[i]);
+    }
+
+    for(int i = first; i <= last; i++){
+        int city = m.genes[i];
+        if(crossover_visited[city])
+            continue;
+        //Follow p's city at the position to where it is in m until leaving the segment
+        int position = i;
+        while(position >= first && position <= last)
+            position = crossover_position[p.genes[position]];
+        Chro->genes[position] = city;
+        mark_visited(city);
+    }
+
+    for(int i = 0; i < chromo_length; i++)
+        if(Chro->genes[i] == 0)
+            Chro->genes[i] = m.genes[i];
+}
+
+//Adds b to the neighbours of a in the edge table, unless it is already there
+void add_edge(int a, int b){
+    int *neighbours = &crossover_edges[a * 4];
+    for(int e = 0; e < crossover_edge_count[a]; e++)
+        if(neighbours[e] == b)
+            return;
+    neighbours[crossover_edge_count[a]++] = b;
+}
+
+//Removes b from the neighbours of a
+void remove_edge(int a, int b){
+    int *neighbours = &crossover_edges[a * 4];
+    for(int e = 0; e < crossover_edge_count[a]; e++){
+        if(neighbours[e] == b){
+            neighbours[e] = neighbours[--crossover_edge_count[a]];
+            return;
         }
-        c++;
-        i++;
-        i = i % chromo_length;
+    }
+}
+
+//Edge recombination crossover (ERX): the child is built from the edges of both parents,
+//always moving to the neighbour with the fewest remaining neighbours
+void create_child_erx(Chromosome p, Chromosome m, Chromosome *Chro, Rng *rng){
+    prepare_child(Chro);
+
+    //Every city has at most 4 neighbours: 2 in each parent
+    for(int city = 1; city <= chromo_length; city++){
+        crossover_edge_count[city] = 0;
+        crossover_unvisited[city - 1] = city;
+        crossover_position[city] = city - 1;
+    }
+    for(int i = 0; i < chromo_length; i++){
+        int next = (i + 1) % chromo_length;
+        add_edge(p.genes[i], p.genes[next]);
+        add_edge(p.genes[next], p.genes[i]);
+        add_edge(m.genes[i], m.genes[next]);
+        add_edge(m.genes[next], m.genes[i]);
+    }
+
+    int unvisited_count = chromo_length;
+    int city = p.genes[0];
+    for(int i = 0; i < chromo_length; i++){
+        Chro->genes[i] = city;
+        mark_visited(city);
+
+        //Remove the city from the unvisited cities (crossover_position holds indices into that list)
+        int index = crossover_position[city];
+        int moved = crossover_unvisited[--unvisited_count];
+        crossover_unvisited[index] = moved;
+        crossover_position[moved] = index;
+
+        int *neighbours = &crossover_edges[city * 4];
+        for(int e = 0; e < crossover_edge_count[city]; e++)
+            remove_edge(neighbours[e], city);
+        if(unvisited_count == 0)
+            break;
+
+        int next = 0;
+        for(int e = 0; e < crossover_edge_count[city]; e++)
+            if(next == 0 || crossover_edge_count[neighbours[e]] < crossover_edge_count[next])
+                next = neighbours[e];
+        if(next == 0) //Dead end: continue from a random unvisited city
+            next = crossover_unvisited[getRandomNumber(rng) % unvisited_count];
+        city = next;
     }
 }
 
 //used to perform crossover of two chromosomes
-void crossoverV2(Chromosome *pop){
+//The children are written into the other gene buffer, the parents follow them there so that
+//the new generation is contiguous in the order of the population. With an odd population the last
+//chromosome gets no child and moves over unchanged
+void crossoverV2(Chromosome *pop, Rng *rng){
+    int *next_genes = gene_buffers[1 - current_buffer];
     int nb = 0;
     for(int i = 0; i < (popl_size / 2); i++){
         do{
-            nb = getRandomNumber() % (popl_size / 2);
+            nb = getRandomNumber(rng) % (popl_size / 2);
         }while(nb == i && percentage_of_difference(pop[i], pop[nb]) < 70);
-        create_ChildV2(pop[i], pop[nb], &pop[(popl_size / 2) + i]);
+
+        Chromosome *child = &pop[(popl_size / 2) + i];
+        child->genes = &next_genes[(size_t)((popl_size / 2) + i) * chromo_length];
+        switch(crossover_operator){
+            case CROSSOVER_OX:
+                create_child_ox(pop[i], pop[nb], child, rng);
+                break;
+            case CROSSOVER_PMX:
+                create_child_pmx(pop[i], pop[nb], child, rng);
+                break;
+            case CROSSOVER_ERX:
+                create_child_erx(pop[i], pop[nb], child, rng);
+                break;
+            default:
+                create_ChildV2(pop[i], pop[nb], child, rng);
+                break;
+        }
+    }
+
+    for(int i = 0; i < (popl_size / 2); i++){
+        int *row = &next_genes[(size_t)i * chromo_length];
+        memcpy(row, pop[i].genes, chromo_length * sizeof(int));
+        pop[i].genes = row;
+    }
+    if(popl_size % 2 == 1){
+        int *row = &next_genes[(size_t)(popl_size - 1) * chromo_length];
+        memcpy(row, pop[popl_size - 1].genes, chromo_length * sizeof(int));
+        pop[popl_size - 1].genes = row;
     }
+    current_buffer = 1 - current_buffer;
 }
 
 //Used to perform mutation in a chromosome
-void mutation(Chromosome *pop){
+void mutation(Chromosome *pop, Rng *rng){
     for(int z = 0; z < 5; z++){
-        int i = getRandomNumber() % chromo_length;
-        int j = getRandomNumber() % chromo_length;
-        int k = getRandomNumber() % (popl_size - (20 * popl_size / 100));
-        int temp = pop[(20 * popl_size / 100) + k].genes[j];
-        pop[(20 * popl_size / 100) + k].genes[j] = pop[(20 * popl_size / 100) + k].genes[i];
-        pop[(20 * popl_size / 100) + k].genes[i] = temp;
+        int i = getRandomNumber(rng) % chromo_length;
+        int j = getRandomNumber(rng) % chromo_length;
+        int k = getRandomNumber(rng) % (popl_size - (20 * popl_size / 100));
+        swap_genes(&pop[(20 * popl_size / 100) + k], i, j);
     }
 }
 
+//Distance between two cities (1-based)
+static inline float city_distance(int a, int b){
+    return distance(a - 1, b - 1);
+}
+
+//Builds the neighbour lists of the local search and checks whether the distances are symmetric
+void init_local_search(){
+    int count = chromo_length - 1 < NEIGHBOURS ? chromo_length - 1 : NEIGHBOURS;
+    neighbour_lists = malloc((size_t)(chromo_length + 1) * NEIGHBOURS * sizeof(int));
+    ls_position = malloc((chromo_length + 1) * sizeof(int));
+    ls_queue = malloc(chromo_length * sizeof(int));
+    ls_in_queue = malloc((chromo_length + 1) * sizeof(unsigned char));
+
+    symmetric_matrix = 1;
+    for(int a = 1; a <= chromo_length; a++){
+        //Insertion into the sorted list of the nearest cities so far. The lists are ordered by d(c, a), the edge
+        //an Or-opt move adds, so that its pruning holds on asymmetric instances; 2-opt runs only on symmetric ones
+        int *nearest = &neighbour_lists[a * NEIGHBOURS];
+        int found = 0;
+        for(int c = 1; c <= chromo_length; c++){
+            if(c == a)
+                continue;
+            if(city_distance(a, c) != city_distance(c, a))
+                symmetric_matrix = 0;
+            if(found == count && city_distance(c, a) >= city_distance(nearest[found - 1], a))
+                continue;
+            int k = found < count ? found++ : found - 1;
+            while(k > 0 && city_distance(nearest[k - 1], a) > city_distance(c, a)){
+                nearest[k] = nearest[k - 1];
+                k--;
+            }
+            nearest[k] = c;
+        }
+        for(int k = found; k < NEIGHBOURS; k++)
+            nearest[k] = 0;
+    }
+}
+
+//Turns the don't-look bit of a city off: it will be tried again
+void activate_city(int city, int *queue_end, int *queue_count){
+    if(ls_in_queue[city])
+        return;
+    ls_in_queue[city] = 1;
+    ls_queue[*queue_end] = city;
+    *queue_end = (*queue_end + 1) % chromo_length;
+    (*queue_count)++;
+}
+
+//Reverses the tour between two positions (going forward, wrapping around), or the rest of the tour if shorter
+void reverse_tour(int *tour, int first, int last){
+    int length = (last - first + chromo_length) % chromo_length + 1;
+    if(2 * length > chromo_length){
+        int rest_first = (last + 1) % chromo_length;
+        last = (first + chromo_length - 1) % chromo_length;
+        first = rest_first;
+        length = chromo_length - length;
+    }
+    for(int k = 0; k < length / 2; k++){
+        int i = (first + k) % chromo_length;
+        int j = (last - k + chromo_length) % chromo_length;
+        int temp = tour[i];
+        tour[i] = tour[j];
+        tour[j] = temp;
+        ls_position[tour[i]] = i;
+        ls_position[tour[j]] = j;
+    }
+}
+
+//Moves the `length` cities starting at position `first` right after city `after`, without reversing them
+void move_segment(int *tour, int first, int length, int after){
+    int segment[3];
+    for(int k = 0; k < length; k++)
+        segment[k] = tour[(first + k) % chromo_length];
+
+    //Either the cities up to `after` move back, or the cities from after's successor move forward
+    int forward = (ls_position[after] - (first + length) + 2 * chromo_length) % chromo_length + 1;
+    int start;
+    if(2 * forward <= chromo_length - length){
+        for(int k = 0; k < forward; k++){
+            int city = tour[(first + length + k) % chromo_length];
+            tour[(first + k) % chromo_length] = city;
+            ls_position[city] = (first + k) % chromo_length;
+        }
+        start = (first + forward) % chromo_length;
+    }
+    else{
+        int backward = chromo_length - length - forward;
+        start = (ls_position[after] + 1) % chromo_length;
+        for(int k = backward - 1; k >= 0; k--){
+            int city = tour[(start + k) % chromo_length];
+            tour[(start + k + length) % chromo_length] = city;
+            ls_position[city] = (start + k + length) % chromo_length;
+        }
+    }
+    for(int k = 0; k < length; k++){
+        tour[(start + k) % chromo_length] = segment[k];
+        ls_position[segment[k]] = (start + k) % chromo_length;
+    }
+}
+
+//Tries the 2-opt and Or-opt moves around a city, applies the first improving one; returns 1 if the tour changed
+int improve_city(int *tour, int a, int *queue_end, int *queue_count){
+    const float epsilon = 1e-4f;
+    int *nearest = &neighbour_lists[a * NEIGHBOURS];
+    int i = ls_position[a];
+
+    if(symmetric_matrix){
+        //... a b ... c d ...  =>  ... a c ... b d ...
+        int b = tour[(i + 1) % chromo_length];
+        for(int k = 0; k < NEIGHBOURS && nearest[k] != 0; k++){
+            int c = nearest[k];
+            if(city_distance(a, c) >= city_distance(a, b))
+                break;
+            int j = ls_position[c];
+            int d = tour[(j + 1) % chromo_length];
+            if(c == b || d == a)
+                continue;
+            if(city_distance(a, c) + city_distance(b, d) - city_distance(a, b) - city_distance(c, d) < -epsilon){
+                reverse_tour(tour, (i + 1) % chromo_length, j);
+                activate_city(b, queue_end, queue_count);
+                activate_city(c, queue_end, queue_count);
+                activate_city(d, queue_end, queue_count);
+                activate_city(a, queue_end, queue_count);
+                return 1;
+            }
+        }
+
+        //... b a ... d c ...  =>  ... b d ... a c ...
+        b = tour[(i + chromo_length - 1) % chromo_length];
+        for(int k = 0; k < NEIGHBOURS && nearest[k] != 0; k++){
+            int c = nearest[k];
+            if(city_distance(a, c) >= city_distance(b, a))
+                break;
+            int j = ls_position[c];
+            int d = tour[(j + chromo_length - 1) % chromo_length];
+            if(c == b || d == a)
+                continue;
+            if(city_distance(a, c) + city_distance(b, d) - city_distance(b, a) - city_distance(d, c) < -epsilon){
+                reverse_tour(tour, i, (j + chromo_length - 1) % chromo_length);
+                activate_city(b, queue_end, queue_count);
+                activate_city(c, queue_end, queue_count);
+                activate_city(d, queue_end, queue_count);
+                activate_city(a, queue_end, queue_count);
+                return 1;
+            }
+        }
+    }
+
+    //Or-opt: the 1 to 3 cities from a move between a city c near a and its successor
+    for(int length = 1; length <= 3; length++){
+        int last = tour[(i + length - 1) % chromo_length];
+        int before = tour[(i + chromo_length - 1) % chromo_length];
+        int after = tour[(i + length) % chromo_length];
+        float removal_gain = city_distance(before, a) + city_distance(last, after) - city_distance(before, after);
+        if(removal_gain <= epsilon)
+            continue;
+        for(int k = 0; k < NEIGHBOURS && nearest[k] != 0; k++){
+            int c = nearest[k];
+            if(city_distance(c, a) >= removal_gain)
+                break;
+            int e = tour[(ls_position[c] + 1) % chromo_length];
+            if(c == before || (ls_position[c] - i + chromo_length) % chromo_length < length)
+                continue;
+            if(city_distance(c, a) + city_distance(last, e) - city_distance(c, e) - removal_gain < -epsilon){
+                move_segment(tour, i, length, c);
+                activate_city(before, queue_end, queue_count);
+                activate_city(after, queue_end, queue_count);
+                activate_city(c, queue_end, queue_count);
+                activate_city(e, queue_end, queue_count);
+                activate_city(last, queue_end, queue_count);
+                activate_city(a, queue_end, queue_count);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+//Improves a chromosome with 2-opt / Or-opt moves until none improves it or the deadline passes
+void local_search(Chromosome *chrom, clock_t deadline){
+    int *tour = chrom->genes;
+    int queue_start = 0, queue_end = 0, queue_count = 0;
+    for(int k = 0; k < chromo_length; k++){
+        ls_position[tour[k]] = k;
+        ls_in_queue[tour[k]] = 0;
+    }
+    for(int k = 0; k < chromo_length; k++)
+        activate_city(tour[k], &queue_end, &queue_count);
+
+    int steps = 0;
+    while(queue_count > 0){
+        if((++steps & 63) == 0 && clock() > deadline)
+            break;
+        int a = ls_queue[queue_start];
+        queue_start = (queue_start + 1) % chromo_length;
+        queue_count--;
+        ls_in_queue[a] = 0;
+        improve_city(tour, a, &queue_end, &queue_count);
+    }
+
+    calculate_fitness(chrom);
+    chrom->local_optimum = queue_count == 0;
+}
+
+//Memetic step: improves the new children with the memetic probability, then the elite, within the time per generation
+void improve_population(Chromosome *pop, Rng *rng){
+    if(memetic_probability <= 0.0f || chromo_length < 8)
+        return;
+    clock_t deadline = clock() + (clock_t)memetic_ms * CLOCKS_PER_SEC / 1000;
+    for(int i = popl_size / 2; i < popl_size && clock() < deadline; i++)
+        if(random_float(rng) < memetic_probability)
+            local_search(&pop[i], deadline);
+    if(!pop[0].local_optimum && !pop[0].dirty)
+        local_search(&pop[0], deadline);
+}
+
 //Calculate actual distance for a chromosome
 float calculate_actual_distance(Chromosome *chrom) {
     float total_distance = 0;
     for(int i = 0; i < chromo_length - 1; i++) {
-        total_distance += dist_matrix[chrom->genes[i] - 1][chrom->genes[i + 1] - 1];
+        total_distance += distance(chrom->genes[i] - 1, chrom->genes[i + 1] - 1);
     }
-    total_distance += dist_matrix[chrom->genes[chromo_length - 1] - 1][chrom->genes[0] - 1];
+    total_distance += distance(chrom->genes[chromo_length - 1] - 1, chrom->genes[0] - 1);
     return total_distance;
 }
 
-//Find generation where algorithm converged (no improvement for 50 generations)
-int find_convergence_generation(float *fitness_history, int total_generations) {
-    if(total_generations < 50) return total_generations;
+//Share of the best chromosome's edges absent from a few random other chromosomes (0: all are the same tour)
+float population_diversity(Chromosome *pop, Rng *rng){
+    int *best = pop[0].genes;
+    int missing = 0;
+    for(int sample = 0; sample < DIVERSITY_SAMPLES; sample++){
+        int *genes = pop[1 + rng_int(rng, popl_size - 1)].genes;
+        for(int k = 0; k < chromo_length; k++)
+            diversity_successor[genes[k]] = genes[(k + 1) % chromo_length];
+        for(int k = 0; k < chromo_length; k++){
+            int a = best[k], b = best[(k + 1) % chromo_length];
+            if(diversity_successor[a] != b && diversity_successor[b] != a)
+                missing++;
+        }
+    }
+    return (float)missing / ((float)DIVERSITY_SAMPLES * chromo_length);
+}
+
+void init_convergence(ConvergenceMonitor *monitor, int generation){
+    monitor->best_fitness = population[0].fitness;
+    monitor->improvement_ewma = 0.0;
+    monitor->last_improvement = generation;
+    monitor->diversity = 1.0f;
+    rng_seed(&monitor->rng, ga_seed ^ 0x5DEECE66DULL);
+}
 
-    for(int i = 50; i < total_generations; i++) {
-        int converged = 1;
-        for(int j = i - 50; j < i; j++) {
-            if(fabs(fitness_history[j] - fitness_history[i]) > 0.000001) {
-                converged = 0;
-                break;
-            }
+//Updates the monitor after a generation; returns 1 if the run has converged, 2 if only the diversity is lost
+int update_convergence(ConvergenceMonitor *monitor, Chromosome *pop, int generation){
+    const double alpha = 2.0 / (STALL_WINDOW + 1);
+    double improvement = 0.0;
+    if(pop[0].fitness > monitor->best_fitness){
+        improvement = (pop[0].fitness - monitor->best_fitness) / monitor->best_fitness;
+        monitor->best_fitness = pop[0].fitness;
+        monitor->last_improvement = generation;
+    }
+    monitor->improvement_ewma = alpha * improvement + (1.0 - alpha) * monitor->improvement_ewma;
+    monitor->diversity = population_diversity(pop, &monitor->rng);
+
+    int stalled_for = generation - monitor->last_improvement;
+    if(stalled_for >= STALL_WINDOW && monitor->improvement_ewma < STALL_EWMA)
+        return 1;
+    if(stalled_for >= STALL_WINDOW / 5 && monitor->diversity < STALL_DIVERSITY)
+        return 2;
+    return 0;
+}
+
+//Restart after a stall: the better half is kept, the rest of the population is replaced by random chromosomes
+void immigration(Chromosome *pop, Rng *rng){
+    for(int i = popl_size / 2; i < popl_size; i++){
+        fill_randomly_the_chromosome(&pop[i], rng);
+        pop[i].local_optimum = 0;
+    }
+    sort_population(pop);
+}
+
+//Wall-clock time [s]
+double wall_time(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+//Evolves a new population for up to no_generation generations, or until the time budget is spent if there is one,
+//and records the outcome in the result
+void evolve_population(TestResult *result, Rng *rng){
+    //Start clock
+    double start = wall_time();
+    double deadline = start + settings.max_exec_time_ms / 1000.0;
+    clock_t crossover_time = 0;
+
+    //Initialise chromosomes
+    for(int i = 0; i < popl_size; i++)
+        fill_randomly_the_chromosome(&population[i], rng);
+
+    sort_population(population);
+
+    ConvergenceMonitor monitor;
+    init_convergence(&monitor, 0);
+    int converged_at = -1;
+
+    int i = 0;
+    while(settings.max_exec_time_ms > 0 ? wall_time() < deadline : i < no_generation){
+        selection(population, rng);
+        clock_t crossover_start = clock();
+        crossoverV2(population, rng);
+        crossover_time += clock() - crossover_start;
+        mutation(population, rng);
+        improve_population(population, rng);
+        calculate_population_fitness(population);
+        sort_population(population);
+        i++;
+
+        int state = update_convergence(&monitor, population, i);
+        if(state == 1 && converged_at < 0)
+            converged_at = monitor.last_improvement;
+        if(state == 1 && stall_action == STALL_STOP)
+            break;
+        if(state != 0 && stall_action == STALL_RESTART){
+#ifdef DEBUG
+            printf("[generation %d: stalled, diversity %.3f, restarting half of the population]\n", i, monitor.diversity);
+#endif
+            immigration(population, rng);
+            init_convergence(&monitor, i);
         }
-        if(converged) return i - 50;
     }
-    return total_generations;
+
+    result->execution_time = wall_time() - start;
+    result->best_fitness = population[0].fitness;
+    result->best_distance = calculate_actual_distance(&population[0]);
+    result->generations = i;
+    result->generations_to_converge = converged_at >= 0 ? converged_at : i;
+    result->children_per_sec = crossover_time > 0 ?
+        (double)i * (popl_size / 2) / ((double)crossover_time / CLOCKS_PER_SEC) : 0.0;
 }
 
 //Clean up population
 void cleanup_population() {
     if(population) {
-        for(int i = 0; i < popl_size; i++) {
-            cleanup_chromosome(&population[i]);
-        }
         free(population);
         population = NULL;
     }
+    free(gene_buffers[0]);
+    free(gene_buffers[1]);
+    gene_buffers[0] = gene_buffers[1] = NULL;
+    free(crossover_visited);
+    free(crossover_position);
+    free(crossover_edges);
+    free(crossover_edge_count);
+    free(crossover_unvisited);
+    free(diversity_successor);
+    diversity_successor = NULL;
+    free(neighbour_lists);
+    free(ls_position);
+    free(ls_queue);
+    free(ls_in_queue);
+    neighbour_lists = ls_position = ls_queue = NULL;
+    ls_in_queue = NULL;
+    crossover_visited = NULL;
+    crossover_position = crossover_edges = crossover_edge_count = crossover_unvisited = NULL;
 }
 
 //Initialize population
@@ -487,15 +1353,38 @@ void init_population(int size) {
     cleanup_population();
     popl_size = size;
     population = (Chromosome *)malloc(popl_size * sizeof(Chromosome));
+    gene_buffers[0] = malloc((size_t)popl_size * chromo_length * sizeof(int));
+    gene_buffers[1] = malloc((size_t)popl_size * chromo_length * sizeof(int));
+    current_buffer = 0;
 
-    // Initialize all chromosome pointers to NULL
+    // Every chromosome starts in its row of the current buffer
     for(int i = 0; i < popl_size; i++) {
-        population[i].genes = NULL;
+        population[i].genes = &gene_buffers[current_buffer][(size_t)i * chromo_length];
         population[i].fitness = 0.0f;
+        population[i].tour_length = 0.0;
+        population[i].dirty = 1;
+        population[i].local_optimum = 0;
     }
+
+    crossover_visited = malloc((chromo_length + 1) * sizeof(unsigned char));
+    crossover_position = malloc((chromo_length + 1) * sizeof(int));
+    crossover_edges = malloc((chromo_length + 1) * 4 * sizeof(int));
+    crossover_edge_count = malloc((chromo_length + 1) * sizeof(int));
+    crossover_unvisited = malloc(chromo_length * sizeof(int));
+    diversity_successor = malloc((chromo_length + 1) * sizeof(int));
+    if(memetic_probability > 0.0f)
+        init_local_search();
+}
+
+//Formats an optimal distance or a gap into buffer (of GAP_TEXT bytes), "n/a" if the optimal distance is unknown
+const char *format_if_known(char *buffer, const char *format, float value, int known) {
+    if(!known)
+        return "n/a";
+    snprintf(buffer, GAP_TEXT, format, value);
+    return buffer;
 }
 
-//Print best solution with path
+//Print best solution with path (optimal: -1 if unknown)
 void print_best_solution(Chromosome *population, const char* instance_name, float optimal) {
 #ifdef DEBUG
     printf("\n=== BEST SOLUTION FOR %s ===\n", instance_name);
@@ -507,81 +1396,50 @@ void print_best_solution(Chromosome *population, const char* instance_name, floa
     printf(" -> %d (return to start)\n", population[0].genes[0]);
 
     float total_distance = calculate_actual_distance(&population[0]);
-    float gap = ((total_distance - optimal) / optimal) * 100.0f;
+    float gap = optimal > 0 ? ((total_distance - optimal) / optimal) * 100.0f : 0.0f;
 
+    char text[2][GAP_TEXT];
     printf("Found Distance: %.2f\n", total_distance);
-    printf("Optimal Distance: %.2f\n", optimal);
-    printf("Gap from Optimal: %.2f%%\n", gap);
+    printf("Optimal Distance: %s\n", format_if_known(text[0], "%.2f", optimal, optimal > 0));
+    printf("Gap from Optimal: %s\n", format_if_known(text[1], "%.2f%%", gap, optimal > 0));
     printf("Fitness Value: %.6f\n", population[0].fitness);
     printf("===============================\n");
 #endif
 }
 
+//Sets the generations of a run on `nodes` cities from the first profile covering them, returns its population size
+int select_profile(const Profile *profiles, int count, int nodes) {
+    const Profile *profile = &profiles[count - 1];
+    for(int p = 0; p < count; p++) {
+        if(nodes <= profiles[p].max_nodes) {
+            profile = &profiles[p];
+            break;
+        }
+    }
+    no_generation = settings.generations > 0 ? settings.generations : profile->generations;
+    return settings.population > 0 ? settings.population : profile->population;
+}
+
 //Run genetic algorithm for given instance
 TestResult run_genetic_algorithm_instance(InstanceData* instance, int run_number) {
     TestResult result;
     strcpy(result.instance_name, instance->name);
     result.nodes = instance->num_nodes;
     result.run = run_number;
-    result.optimal_distance = instance->optimal_value;
-
-    // Adjust parameters based on problem size
-    int target_popl_size, target_generations;
-    if(instance->num_nodes <= 8) {
-        target_popl_size = 50;
-        target_generations = 300;
-    } else if(instance->num_nodes <= 12) {
-        target_popl_size = 75;
-        target_generations = 400;
-    } else if(instance->num_nodes <= 16) {
-        target_popl_size = 100;
-        target_generations = 500;
-    } else if(instance->num_nodes <= 25) {
-        target_popl_size = 150;
-        target_generations = 600;
-    } else {
-        target_popl_size = 200;
-        target_generations = 800;
-    }
-
-    no_generation = target_generations;
+    result.optimal_distance = instance->optimum_known ? instance->optimal_value : -1;
 
-    init_dist_matrix_from_instance(instance);
-    init_population(target_popl_size);
-
-    // Track fitness history for convergence analysis
-    float *fitness_history = malloc(no_generation * sizeof(float));
-
-    //Start clock
-    clock_t start = clock();
+    // Parameters of the instance's size
+    int target_popl_size = select_profile(settings.instance_profiles, settings.instance_profile_count, instance->num_nodes);
 
-    //Initialise chromosomes
-    for(int i = 0; i < popl_size; i++)
-        fill_randomly_the_chromosome(&population[i]);
+    // Every run has its own seed, so a single run can be repeated
+    Rng rng;
+    rng_seed(&rng, ga_seed + run_number);
 
-    sort_population(population);
-    fitness_history[0] = population[0].fitness;
-
-    int i = 0;
-    while(i < no_generation){
-        selection(population);
-        crossoverV2(population);
-        mutation(population);
-        calculate_population_fitness(population);
-        sort_population(population);
-
-        fitness_history[i] = population[0].fitness;
-        i++;
-    }
-
-    clock_t end = clock();
-    result.execution_time = ((double)(end - start)) / CLOCKS_PER_SEC;
-    result.best_fitness = population[0].fitness;
-    result.best_distance = calculate_actual_distance(&population[0]);
-    result.generations_to_converge = find_convergence_generation(fitness_history, no_generation);
-    result.gap_percentage = ((result.best_distance - result.optimal_distance) / result.optimal_distance) * 100.0f;
-
-    free(fitness_history);
+    init_dist_matrix_from_instance(instance);
+    init_population(target_popl_size);
+    evolve_population(&result, &rng);
+    result.gap_percentage = result.optimal_distance > 0 ?
+        ((result.best_distance - result.optimal_distance) / result.optimal_distance) * 100.0f : 0.0f;
     return result;
 }
 
@@ -593,72 +1451,40 @@ TestResult run_genetic_algorithm_random(int num_nodes, int run_number) {
     result.run = run_number;
     result.optimal_distance = -1; // Unknown for random graphs
 
-    // Adjust parameters based on problem size
-    int target_popl_size, target_generations;
-    if(num_nodes <= 8) {
-        target_popl_size = 50;
-        target_generations = 300;
-    } else if(num_nodes <= 12) {
-        target_popl_size = 75;
-        target_generations = 400;
-    } else if(num_nodes <= 16) {
-        target_popl_size = 100;
-        target_generations = 500;
-    } else {
-        target_popl_size = 150;
-        target_generations = 600;
-    }
-
-    no_generation = target_generations;
-
-    init_random_dist_matrix(num_nodes);
-    init_population(target_popl_size);
-
-    // Track fitness history for convergence analysis
-    float *fitness_history = malloc(no_generation * sizeof(float));
-
-    //Start clock
-    clock_t start = clock();
-
-    //Initialise chromosomes
-    for(int i = 0; i < popl_size; i++)
-        fill_randomly_the_chromosome(&population[i]);
-
-    sort_population(population);
-    fitness_history[0] = population[0].fitness;
-
-    int i = 0;
-    while(i < no_generation){
-        selection(population);
-        crossoverV2(population);
-        mutation(population);
-        calculate_population_fitness(population);
-        sort_population(population);
+    // Parameters of the graph's size
+    int target_popl_size = select_profile(settings.random_profiles, settings.random_profile_count, num_nodes);
 
-        fitness_history[i] = population[0].fitness;
-        i++;
-    }
+    // Every run has its own seed, so a single run can be repeated
+    Rng rng;
+    rng_seed(&rng, ga_seed + ((uint64_t)num_nodes << 32) + run_number);
 
-    clock_t end = clock();
-    result.execution_time = ((double)(end - start)) / CLOCKS_PER_SEC;
-    result.best_fitness = population[0].fitness;
-    result.best_distance = calculate_actual_distance(&population[0]);
-    result.generations_to_converge = find_convergence_generation(fitness_history, no_generation);
+    init_random_dist_matrix(num_nodes, &rng);
+    init_population(target_popl_size);
+    evolve_population(&result, &rng);
     result.gap_percentage = 0.0f; // Not applicable for random graphs
-
-    free(fitness_history);
     return result;
 }
 
 //Print usage information
 void print_usage(const char* program_name) {
     printf("Usage:\n");
-    printf("  %s                              - Run batch testing (random graphs 5-20 nodes)\n", program_name);
+    printf("  %s                              - Run batch testing (random graphs, 5-30 nodes by default)\n", program_name);
     printf("  %s instance_mode                - Run all instances from 'instances' directory\n", program_name);
     printf("  %s instance_mode -r <runs>      - Run all instances with specified number of runs\n", program_name);
     printf("  %s -f <filename>                - Run single instance from file\n", program_name);
     printf("  %s -f <filename> -r <runs>      - Run single instance multiple times\n", program_name);
     printf("  %s -h                           - Show this help\n", program_name);
+    printf("\nOptions (accepted with every mode):\n");
+    printf("  -c <v2|ox|pmx|erx>             - Crossover operator (default v2)\n");
+    printf("  --seed <n>                     - Seed of the random number generator (default: current time)\n");
+    printf("  --on-stall <stop|restart|none> - When the run stops improving: end it (default), restart half of the\n");
+    printf("                                   population, or always run all the generations\n");
+    printf("  --memetic <p>                  - Improve children with 2-opt/Or-opt with probability p (default 0: off)\n");
+    printf("  --ls-ms <ms>                   - Local search time per generation in memetic mode (default 20)\n");
+    printf("  --time-ms <ms>                 - Wall-clock budget of every run instead of the generation count\n");
+    printf("  --population <n>               - Population size of every run (default: from the size profile)\n");
+    printf("  --generations <n>              - Generations of every run (default: from the size profile)\n");
+    printf("  --config <file>                - Settings file (default %s, if present)\n", SETTINGS_FILE);
     printf("\nDirectory structure:\n");
     printf("  ./instances/          - Input TSP instance files\n");
     printf("    ├── instance1.tsp\n");
@@ -675,6 +1501,210 @@ void print_usage(const char* program_name) {
     printf("  Last line: Optimal value\n");
 }
 
+//Sets one parameter by its settings file key; returns 0 if the value is invalid
+int apply_setting(const char *key, const char *value) {
+    char *end;
+    long number = strtol(value, &end, 10);
+    int is_number = value[0] != '\0' && *end == '\0';
+
+    if(strcmp(key, "crossover") == 0) {
+        for(int op = CROSSOVER_V2; op <= CROSSOVER_ERX; op++) {
+            if(strcmp(value, crossover_names[op]) == 0) {
+                crossover_operator = (CrossoverOperator)op;
+                return 1;
+            }
+        }
+        printf("Unknown crossover operator: %s\n", value);
+        return 0;
+    }
+    else if(strcmp(key, "seed") == 0) {
+        ga_seed = strtoull(value, &end, 10);
+        if(*end != '\0' || value[0] == '\0' || value[0] == '-') {
+            printf("Invalid seed: %s\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "on_stall") == 0) {
+        for(int action = STALL_STOP; action <= STALL_IGNORE; action++) {
+            if(strcmp(value, stall_action_names[action]) == 0) {
+                stall_action = (StallAction)action;
+                return 1;
+            }
+        }
+        printf("Unknown stall action: %s\n", value);
+        return 0;
+    }
+    else if(strcmp(key, "memetic") == 0) {
+        // Only plain decimal numbers: nan and inf would pass the range test under -ffast-math
+        memetic_probability = strtof(value, &end);
+        if(value[0] == '\0' || *end != '\0' || value[strspn(value, "0123456789.eE+-")] != '\0' ||
+           memetic_probability < 0.0f || memetic_probability > 1.0f) {
+            printf("Invalid memetic probability: %s (must be 0-1)\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "ls_ms") == 0) {
+        memetic_ms = is_number ? (int)number : 0;
+        if(memetic_ms <= 0) {
+            printf("Invalid local search time: %s\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "max_exec_time_ms") == 0) {
+        settings.max_exec_time_ms = is_number ? number : -1;
+        if(settings.max_exec_time_ms < 0) {
+            printf("Invalid time budget: %s\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "population") == 0) {
+        settings.population = is_number ? (int)number : -1;
+        if(settings.population != 0 && settings.population < 4) {
+            printf("Invalid population size: %s (must be at least 4)\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "generations") == 0) {
+        settings.generations = is_number ? (int)number : -1;
+        if(settings.generations < 0) {
+            printf("Invalid number of generations: %s\n", value);
+            return 0;
+        }
+    }
+    else if(strcmp(key, "min_nodes") == 0 || strcmp(key, "max_nodes") == 0 || strcmp(key, "num_runs") == 0) {
+        int *target = key[0] == 'n' ? &settings.num_runs : key[1] == 'i' ? &settings.min_nodes : &settings.max_nodes;
+        *target = is_number ? (int)number : 0;
+        if(*target <= 0) {
+            printf("Invalid %s: %s\n", key, value);
+            return 0;
+        }
+    }
+    else {
+        printf("Unknown setting: %s\n", key);
+        return 0;
+    }
+    return 1;
+}
+
+//Adds a size profile "<max nodes or *> = <population> <generations>" to a profile list
+int add_profile(Profile *profiles, int *count, const char *key, const char *value) {
+    Profile profile;
+    profile.max_nodes = strcmp(key, "*") == 0 ? INT_MAX : atoi(key);
+    if(*count == MAX_PROFILES || profile.max_nodes <= 0 ||
+       sscanf(value, "%d %d", &profile.population, &profile.generations) != 2 ||
+       profile.population < 4 || profile.generations <= 0) {
+        printf("Invalid profile: %s = %s\n", key, value);
+        return 0;
+    }
+    if(*count > 0 && profile.max_nodes <= profiles[*count - 1].max_nodes) {
+        printf("Profiles must be ordered by their number of nodes: %s\n", key);
+        return 0;
+    }
+    profiles[(*count)++] = profile;
+    return 1;
+}
+
+//Reads an ini settings file: "key = value" parameters, and the size profiles of the
+//[instance_profiles] and [random_profiles] sections, which replace the built-in ones
+int read_settings_file(const char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if(!fp) {
+        printf("Error: Cannot open settings file %s\n", filename);
+        return 0;
+    }
+
+    // The profiles of the file replace the built-in ones only once the whole file is read
+    Profile instance_list[MAX_PROFILES], random_list[MAX_PROFILES];
+    char line[MAX_LINE];
+    char section[MAX_LINE] = "";
+    int line_number = 0;
+    int instance_profiles = 0, random_profiles = 0;
+    int valid = 1;
+    while(valid && fgets(line, sizeof(line), fp)) {
+        char key[MAX_LINE], value[MAX_LINE];
+        line_number++;
+        if(sscanf(line, " %255s", key) != 1 || key[0] == ';' || key[0] == '#')
+            continue;
+        if(sscanf(line, " [%255[^]]]", section) == 1)
+            continue;
+
+        if(sscanf(line, " %255[^= \t] = %255[^\r\n]", key, value) != 2) {
+            printf("Invalid line: %s", line);
+            valid = 0;
+        } else if(strcmp(section, "instance_profiles") == 0) {
+            valid = add_profile(instance_list, &instance_profiles, key, value);
+        } else if(strcmp(section, "random_profiles") == 0) {
+            valid = add_profile(random_list, &random_profiles, key, value);
+        } else {
+            for(int end = (int)strlen(value); end > 0 && (value[end - 1] == ' ' || value[end - 1] == '\t'); end--)
+                value[end - 1] = '\0';
+            valid = apply_setting(key, value);
+        }
+    }
+    fclose(fp);
+    if(!valid) {
+        printf("Error in settings file %s, line %d\n", filename, line_number);
+        return 0;
+    }
+    if(instance_profiles > 0) {
+        memcpy(settings.instance_profiles, instance_list, instance_profiles * sizeof(Profile));
+        settings.instance_profile_count = instance_profiles;
+    }
+    if(random_profiles > 0) {
+        memcpy(settings.random_profiles, random_list, random_profiles * sizeof(Profile));
+        settings.random_profile_count = random_profiles;
+    }
+    return 1;
+}
+
+//Reads the settings file, then removes the options valid in every mode from argv, so that only the mode arguments remain
+int parse_options(int *argc, char **argv) {
+    // Command line options and the settings they set
+    static const char *options[][2] = {
+        {"-c", "crossover"}, {"--seed", "seed"}, {"--on-stall", "on_stall"}, {"--memetic", "memetic"},
+        {"--ls-ms", "ls_ms"}, {"--time-ms", "max_exec_time_ms"}, {"--population", "population"},
+        {"--generations", "generations"}
+    };
+    const int option_count = sizeof(options) / sizeof(options[0]);
+
+    // The settings file comes first, the command line overrides it
+    const char *settings_file = NULL;
+    for(int i = 1; i + 1 < *argc; i++)
+        if(strcmp(argv[i], "--config") == 0)
+            settings_file = argv[++i];
+    struct stat st;
+    if(settings_file == NULL && stat(SETTINGS_FILE, &st) == 0)
+        settings_file = SETTINGS_FILE;
+    if(settings_file && !read_settings_file(settings_file))
+        return 0;
+
+    int kept = 1;
+    for(int i = 1; i < *argc; i++) {
+        int option = 0;
+        while(option < option_count && strcmp(argv[i], options[option][0]) != 0)
+            option++;
+        if(strcmp(argv[i], "--config") == 0 && i + 1 < *argc) {
+            i++;
+        }
+        else if(option < option_count && i + 1 < *argc) {
+            if(!apply_setting(options[option][1], argv[i + 1]))
+                return 0;
+            i++;
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+
+    if(settings.min_nodes < 3 || settings.max_nodes < settings.min_nodes) {
+        printf("Invalid node range: %d-%d\n", settings.min_nodes, settings.max_nodes);
+        return 0;
+    }
+    return 1;
+}
+
 //Print comprehensive summary for all instances
 void print_all_instances_summary(TestResult *results, int total_results) {
 #ifdef DEBUG
@@ -684,10 +1714,13 @@ void print_all_instances_summary(TestResult *results, int total_results) {
     printf("---------------------------------------------------------------------------------\n");
 
     for(int i = 0; i < total_results; i++) {
-        printf("%-15s %-6d %-4d %-10.4f %-10.1f %-10.1f %-8.2f %-8d\n",
+        char text[2][GAP_TEXT];
+        int known = results[i].optimal_distance > 0;
+        printf("%-15s %-6d %-4d %-10.4f %-10.1f %-10s %-8s %-8d\n",
                results[i].instance_name, results[i].nodes, results[i].run,
                results[i].execution_time, results[i].best_distance,
-               results[i].optimal_distance, results[i].gap_percentage,
+               format_if_known(text[0], "%.1f", results[i].optimal_distance, known),
+               format_if_known(text[1], "%.2f", results[i].gap_percentage, known),
                results[i].generations_to_converge);
     }
 
@@ -731,7 +1764,7 @@ void print_all_instances_summary(TestResult *results, int total_results) {
                 avg_time += results[i].execution_time;
                 avg_distance += results[i].best_distance;
                 avg_gap += results[i].gap_percentage;
-                if(results[i].gap_percentage <= 5.0) success_runs++;
+                if(results[i].optimal_distance > 0 && results[i].gap_percentage <= 5.0) success_runs++;
                 total_runs++;
                 nodes = results[i].nodes;
                 optimal = results[i].optimal_distance;
@@ -739,10 +1772,12 @@ void print_all_instances_summary(TestResult *results, int total_results) {
         }
 
         if(total_runs > 0) {
-            printf("%-15s %-6d %-10.4f %-10.1f %-8.1f %-8.2f %d/%d\n",
+            char text[2][GAP_TEXT];
+            printf("%-15s %-6d %-10.4f %-10.1f %-8s %-8s %d/%d\n",
                    unique_instances[inst], nodes,
-                   avg_time/total_runs, avg_distance/total_runs, optimal,
-                   avg_gap/total_runs, success_runs, total_runs);
+                   avg_time/total_runs, avg_distance/total_runs,
+                   format_if_known(text[0], "%.1f", optimal, optimal > 0),
+                   format_if_known(text[1], "%.2f", avg_gap/total_runs, optimal > 0), success_runs, total_runs);
         }
     }
 #endif
@@ -755,10 +1790,13 @@ void print_instance_summary_table(TestResult *results, int total_results) {
     printf("--------------------------------------------------------------------------------------\n");
 
     for(int i = 0; i < total_results; i++) {
-        printf("%-12s %-6d %-4d %-12.4f %-12.2f %-12.2f %-12.2f %-10d\n",
+        char text[2][GAP_TEXT];
+        int known = results[i].optimal_distance > 0;
+        printf("%-12s %-6d %-4d %-12.4f %-12.2f %-12s %-12s %-10d\n",
                results[i].instance_name, results[i].nodes, results[i].run,
                results[i].execution_time, results[i].best_distance,
-               results[i].optimal_distance, results[i].gap_percentage,
+               format_if_known(text[0], "%.2f", results[i].optimal_distance, known),
+               format_if_known(text[1], "%.2f", results[i].gap_percentage, known),
                results[i].generations_to_converge);
     }
 
@@ -777,9 +1815,11 @@ void print_instance_summary_table(TestResult *results, int total_results) {
         }
 
         printf("--------------------------------------------------------------------------------------\n");
-        printf("%-12s %-6s %-4s %-12.4f %-12.2f %-12s %-12.2f %-10d\n",
+        char gap[GAP_TEXT];
+        printf("%-12s %-6s %-4s %-12.4f %-12.2f %-12s %-12s %-10d\n",
                "AVERAGE", "", "", avg_time/total_results, avg_distance/total_results,
-               "", avg_gap/total_results, avg_conv/total_results);
+               "", format_if_known(gap, "%.2f", avg_gap/total_results, results[0].optimal_distance > 0),
+               avg_conv/total_results);
     }
 #endif
 }
@@ -805,7 +1845,7 @@ void print_summary_table(TestResult *results, int total_results) {
            "Number of vertices", "Avg.Time(s)", "Avg.Distance", "Avg.Fitness", "Avg.Conv");
     printf("------------------------------------------------------\n");
 
-    for(int nodes = MIN_NODES; nodes <= MAX_NODES; nodes++) {
+    for(int nodes = settings.min_nodes; nodes <= settings.max_nodes; nodes++) {
         double avg_time = 0;
         float avg_distance = 0;
         float avg_fitness = 0;
@@ -846,13 +1886,17 @@ void save_results_to_csv(TestResult *results, int total_results, const char* fil
         return;
     }
 
-    fprintf(fp, "Instance,Number of vertices,Run,ExecutionTime,BestDistance,OptimalDistance,GapPercentage,BestFitness,ConvergenceGeneration\n");
+    fprintf(fp, "Instance,Number of vertices,Run,ExecutionTime,BestDistance,OptimalDistance,GapPercentage,BestFitness,ConvergenceGeneration,Generations,Crossover,ChildrenPerSecond\n");
     for(int i = 0; i < total_results; i++) {
-        fprintf(fp, "%s,%d,%d,%.6f,%.2f,%.2f,%.2f,%.6f,%d\n",
+        char text[2][GAP_TEXT];
+        int known = results[i].optimal_distance > 0;
+        fprintf(fp, "%s,%d,%d,%.6f,%.2f,%s,%s,%.6f,%d,%d,%s,%.0f\n",
                 results[i].instance_name, results[i].nodes, results[i].run,
                 results[i].execution_time, results[i].best_distance,
-                results[i].optimal_distance, results[i].gap_percentage,
-                results[i].best_fitness, results[i].generations_to_converge);
+                format_if_known(text[0], "%.2f", results[i].optimal_distance, known),
+                format_if_known(text[1], "%.2f", results[i].gap_percentage, known),
+                results[i].best_fitness, results[i].generations_to_converge, results[i].generations,
+                crossover_names[crossover_operator], results[i].children_per_sec);
     }
 
     fclose(fp);
@@ -897,15 +1941,18 @@ void save_summary_report(TestResult *results, int total_results, const char* fil
     fprintf(fp, "---------------------------------------------------------------------------------\n");
 
     for(int i = 0; i < total_results; i++) {
-        fprintf(fp, "%-15s %-6d %-4d %-10.4f %-10.1f %-10.1f %-8.2f %-8d\n",
+        char text[2][GAP_TEXT];
+        int known = results[i].optimal_distance > 0;
+        fprintf(fp, "%-15s %-6d %-4d %-10.4f %-10.1f %-10s %-8s %-8d\n",
                results[i].instance_name, results[i].nodes, results[i].run,
                results[i].execution_time, results[i].best_distance,
-               results[i].optimal_distance, results[i].gap_percentage,
+               format_if_known(text[0], "%.1f", results[i].optimal_distance, known),
+               format_if_known(text[1], "%.2f", results[i].gap_percentage, known),
                results[i].generations_to_converge);
     }
 
     // Calculate statistics for instances (if applicable)
-    if(results[0].optimal_distance > 0) { // Instance mode
+    if(strcmp(results[0].instance_name, "Random") != 0) { // Instance mode
         fprintf(fp, "\nSTATISTICAL SUMMARY:\n");
 
         // Find unique instances
@@ -944,7 +1991,7 @@ void save_summary_report(TestResult *results, int total_results, const char* fil
                     avg_time += results[i].execution_time;
                     avg_distance += results[i].best_distance;
                     avg_gap += results[i].gap_percentage;
-                    if(results[i].gap_percentage <= 5.0) success_runs++;
+                    if(results[i].optimal_distance > 0 && results[i].gap_percentage <= 5.0) success_runs++;
                     total_runs++;
                     nodes = results[i].nodes;
                     optimal = results[i].optimal_distance;
@@ -952,10 +1999,12 @@ void save_summary_report(TestResult *results, int total_results, const char* fil
             }
 
             if(total_runs > 0) {
-                fprintf(fp, "%-15s %-6d %-10.4f %-10.1f %-8.1f %-8.2f %d/%d\n",
+                char text[2][GAP_TEXT];
+                fprintf(fp, "%-15s %-6d %-10.4f %-10.1f %-8s %-8s %d/%d\n",
                        unique_instances[inst], nodes,
-                       avg_time/total_runs, avg_distance/total_runs, optimal,
-                       avg_gap/total_runs, success_runs, total_runs);
+                       avg_time/total_runs, avg_distance/total_runs,
+                       format_if_known(text[0], "%.1f", optimal, optimal > 0),
+                       format_if_known(text[1], "%.2f", avg_gap/total_runs, optimal > 0), success_runs, total_runs);
             }
         }
     } else { // Random graph mode
@@ -964,7 +2013,7 @@ void save_summary_report(TestResult *results, int total_results, const char* fil
                "Number of vertices", "Avg.Time(s)", "Avg.Distance", "Avg.Fitness", "Avg.Conv");
         fprintf(fp, "------------------------------------------------------\n");
 
-        for(int nodes = MIN_NODES; nodes <= MAX_NODES; nodes++) {
+        for(int nodes = settings.min_nodes; nodes <= settings.max_nodes; nodes++) {
             double avg_time = 0;
             float avg_distance = 0;
             float avg_fitness = 0;
@@ -1046,37 +2095,45 @@ void save_best_solution(Chromosome *chromosome, const char* instance_name, float
 }
 
 int main(int argc, char **argv){
-    // Seed random number generator
-    srand(time(NULL));
+    // Seed of the random number generators, replaced by --seed
+    ga_seed = (unsigned long long)time(NULL);
+
+    if(!parse_options(&argc, argv)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    printf("Seed: %llu\n", ga_seed);
+    if(settings.max_exec_time_ms > 0)
+        printf("Time budget: %ld ms per run\n", settings.max_exec_time_ms);
 
     // Parse command line arguments
     if(argc == 1) {
         // Default batch mode - random graphs
         printf("=== GA TSP COMPREHENSIVE TESTING (RANDOM GRAPHS) ===\n");
-        printf("Testing node counts from %d to %d\n", MIN_NODES, MAX_NODES);
-        printf("Number of runs per node count: %d\n", NUM_RUNS);
+        printf("Testing node counts from %d to %d\n", settings.min_nodes, settings.max_nodes);
+        printf("Number of runs per node count: %d\n", settings.num_runs);
         printf("Base edge weight: %.1f ± %.1f%%\n", BASE_WEIGHT, WEIGHT_VARIATION * 100);
         printf("====================================================\n\n");
 
-        int total_tests = (MAX_NODES - MIN_NODES + 1) * NUM_RUNS;
+        int total_tests = (settings.max_nodes - settings.min_nodes + 1) * settings.num_runs;
         TestResult *results = malloc(total_tests * sizeof(TestResult));
         int result_index = 0;
 
         // Run tests for each node count
-        for(int nodes = MIN_NODES; nodes <= MAX_NODES; nodes++) {
+        for(int nodes = settings.min_nodes; nodes <= settings.max_nodes; nodes++) {
             printf("Testing with %d nodes:\n", nodes);
 
-            for(int run = 1; run <= NUM_RUNS; run++) {
+            for(int run = 1; run <= settings.num_runs; run++) {
 #ifdef DEBUG
-                printf("  Run %d/%d...", run, NUM_RUNS);
+                printf("  Run %d/%d...", run, settings.num_runs);
                 fflush(stdout);
 #endif
 
                 TestResult result = run_genetic_algorithm_random(nodes, run);
                 results[result_index++] = result;
 
-                printf("Time: %.4fs, Distance: %.2f, Fitness: %.6f\n",
-                       result.execution_time, result.best_distance, result.best_fitness);
+                printf("Time: %.4fs, Distance: %.2f, Fitness: %.6f, Children/s: %.0f\n",
+                       result.execution_time, result.best_distance, result.best_fitness, result.children_per_sec);
             }
             printf("\n");
         }
@@ -1086,13 +2143,15 @@ int main(int argc, char **argv){
 
         // Save to CSV and summary report
         save_results_to_csv(results, total_tests, "ga_tsp_random_results.csv");
-        save_summary_report(results, total_tests, "ga_tsp_random_summary.txt", "Random Graph Testing (5-20 nodes)");
+        char title[MAX_LINE];
+        snprintf(title, sizeof(title), "Random Graph Testing (%d-%d nodes)", settings.min_nodes, settings.max_nodes);
+        save_summary_report(results, total_tests, "ga_tsp_random_summary.txt", title);
 
         free(results);
     }
     else if(argc >= 2 && strcmp(argv[1], "instance_mode") == 0) {
         // Instance directory mode
-        int num_runs = NUM_RUNS; // Default number of runs
+        int num_runs = settings.num_runs; // Default number of runs
 
         // Check for number of runs argument
         if(argc >= 4 && strcmp(argv[2], "-r") == 0) {
@@ -1152,8 +2211,11 @@ int main(int argc, char **argv){
                 TestResult result = run_genetic_algorithm_instance(&instance, run);
                 all_results[result_index++] = result;
 
-                printf("Time: %.4fs, Distance: %.1f, Gap: %.2f%%\n",
-                       result.execution_time, result.best_distance, result.gap_percentage);
+                char gap[GAP_TEXT];
+                printf("Time: %.4fs, Distance: %.1f, Gap: %s, Children/s: %.0f\n",
+                       result.execution_time, result.best_distance,
+                       format_if_known(gap, "%.2f%%", result.gap_percentage, result.optimal_distance > 0),
+                       result.children_per_sec);
             }
 
             // Print summary for this instance
@@ -1171,24 +2233,27 @@ int main(int argc, char **argv){
                 }
 
                 // Re-run to get solution path (quick run for display)
+                Rng rng;
+                rng_seed(&rng, ga_seed);
                 init_dist_matrix_from_instance(&instance);
                 init_population(100);
 
                 for(int i = 0; i < popl_size; i++)
-                    fill_randomly_the_chromosome(&population[i]);
+                    fill_randomly_the_chromosome(&population[i], &rng);
                 sort_population(population);
 
                 // Quick optimization
                 for(int gen = 0; gen < 50; gen++) {
-                    selection(population);
-                    crossoverV2(population);
-                    mutation(population);
+                    selection(population, &rng);
+                    crossoverV2(population, &rng);
+                    mutation(population, &rng);
+                    improve_population(population, &rng);
                     calculate_population_fitness(population);
                     sort_population(population);
                 }
 
-                print_best_solution(population, instance.name, instance.optimal_value);
-                save_best_solution(&population[0], instance.name, instance.optimal_value, instance.num_nodes);
+                print_best_solution(population, instance.name, instance.optimum_known ? instance.optimal_value : -1);
+                save_best_solution(&population[0], instance.name, instance.optimum_known ? instance.optimal_value : -1, instance.num_nodes);
             }
 
             cleanup_instance_data(&instance);
@@ -1251,8 +2316,11 @@ int main(int argc, char **argv){
             TestResult result = run_genetic_algorithm_instance(&instance, run);
             results[run-1] = result;
 
-            printf("Time: %.4fs, Distance: %.2f, Gap: %.2f%%\n",
-                   result.execution_time, result.best_distance, result.gap_percentage);
+            char gap[GAP_TEXT];
+            printf("Time: %.4fs, Distance: %.2f, Gap: %s, Children/s: %.0f\n",
+                   result.execution_time, result.best_distance,
+                   format_if_known(gap, "%.2f%%", result.gap_percentage, result.optimal_distance > 0),
+                   result.children_per_sec);
         }
 
         // Print detailed results
@@ -1269,24 +2337,27 @@ int main(int argc, char **argv){
             }
 
             // Re-run the best case to get the solution path
+            Rng rng;
+            rng_seed(&rng, ga_seed);
             init_dist_matrix_from_instance(&instance);
             init_population(100);
 
             for(int i = 0; i < popl_size; i++)
-                fill_randomly_the_chromosome(&population[i]);
+                fill_randomly_the_chromosome(&population[i], &rng);
             sort_population(population);
 
             // Run a quick optimization to get a good solution for display
             for(int gen = 0; gen < 100; gen++) {
-                selection(population);
-                crossoverV2(population);
-                mutation(population);
+                selection(population, &rng);
+                crossoverV2(population, &rng);
+                mutation(population, &rng);
+                improve_population(population, &rng);
                 calculate_population_fitness(population);
                 sort_population(population);
             }
 
-            print_best_solution(population, instance.name, instance.optimal_value);
-            save_best_solution(&population[0], instance.name, instance.optimal_value, instance.num_nodes);
+            print_best_solution(population, instance.name, instance.optimum_known ? instance.optimal_value : -1);
+            save_best_solution(&population[0], instance.name, instance.optimum_known ? instance.optimal_value : -1, instance.num_nodes);
         }
 
         // Save to CSV and summary report
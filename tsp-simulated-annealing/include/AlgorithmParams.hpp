@@ -3,14 +3,133 @@
 
 #include <iostream>
 #include "TSPAlgorithm.hpp"
+#include "Trace.hpp"
+
+enum SolverType
+{
+    SimulatedAnnealingSolver,
+    ParallelTemperingSolver,
+    // 2-opt local search from the initial path
+    TwoOptSolver,
+    // Chained Lin-Kernighan style local search
+    LinKernighanSolver,
+    TabuSearchSolver,
+};
+
+enum CoolingSchedule
+{
+    // T = T * coolingRate every iteration
+    GeometricCooling,
+    // T = T / (1 + beta * T) every iteration, beta = lundyMeesCoefficient / T0
+    LundyMeesCooling,
+    // T = T * chainCoolingRate after every chain of chainLengthFactor * n iterations
+    MarkovChainCooling,
+    // After every chain the temperature is adjusted so that the acceptance ratio follows a target
+    // decreasing geometrically over the execution time budget
+    AdaptiveCooling,
+};
+
+enum InitialTemperatureMode
+{
+    // From the weight changes of a sample of random moves
+    SampledTemperature,
+    // temperatureCoefficient * average absolute deviation of the edge weights (full matrix pass)
+    AadTemperature,
+};
+
+struct CoolingParams
+{
+    CoolingSchedule schedule = GeometricCooling;
+    InitialTemperatureMode initialTemperatureMode = SampledTemperature;
+    // Probability of accepting an average worsening move at the initial temperature (sampled mode)
+    double initialAcceptance = 0.5;
+    double lundyMeesCoefficient = 1e-4;
+    // Length of the chain at one temperature = chainLengthFactor * number of vertices
+    int chainLengthFactor = 10;
+    double chainCoolingRate = 0.95;
+    // Target acceptance ratio at the beginning and at the end of the execution time (adaptive cooling)
+    double initialTargetAcceptance = 0.3;
+    double finalTargetAcceptance = 0.001;
+    // Reheat after reheatAfterFactor * number of vertices iterations without improvement (0 disables)
+    int reheatAfterFactor = 0;
+    // The temperature after reheating = reheatRatio * initial temperature
+    double reheatRatio = 0.1;
+};
+
+struct MoveBatchParams
+{
+    // Number of candidate moves evaluated at once (swap / invert on undirected graphs), 0 or 1 disables
+    int size = 0;
+    // Below bestOfBatchRatio * T0 only the best move of every batch is tried (0 disables)
+    double bestOfBatchRatio = 0.0;
+};
+
+struct CheckpointParams
+{
+    // Save checkpoints of the simulated annealing runs (resumed with --resume <checkpoint file>)
+    bool enabled = false;
+    // Interval between two checkpoints of a run [ms]
+    int everyMs = 10000;
+};
+
+struct ParallelTemperingParams
+{
+    // Number of replicas (each runs on its own thread), 0 = number of hardware threads
+    int replicas = 0;
+    // Ratio of the lowest to the highest temperature of the ladder
+    double temperatureRatio = 1e-6;
+    // Number of iterations of every replica between two exchange attempts
+    int exchangeInterval = 10000;
+};
+
+struct TabuSearchParams
+{
+    // Number of iterations in which a removed edge may not be added back, 0 = chosen from the number of vertices
+    int tenure = 0;
+    // Number of threads evaluating the neighborhood, 0 = number of hardware threads
+    int threads = 0;
+    // The neighborhood is evaluated in parallel for graphs with at least this number of vertices
+    int parallelMinVertices = 2000;
+};
+
+enum TourType
+{
+    // Array of vertices with the array of their positions, O(n) reversal
+    ArrayTourType,
+    // Two-level doubly-linked list, O(sqrt(n)) reversal
+    TwoLevelListTourType,
+};
+
+struct LocalSearchParams
+{
+    // Number of candidates (nearest vertices) of every vertex
+    int neighborCount = 10;
+    // Improve the result of the simulated annealing / parallel tempering with 2-opt
+    bool polish = false;
+    // Maximum number of steps of a Lin-Kernighan move
+    int lkMaxDepth = 50;
+    // Number of alternatives of the first step of a Lin-Kernighan move
+    int lkBreadth = 5;
+    // Tour representation of the 2-opt and Lin-Kernighan moves
+    TourType tour = ArrayTourType;
+};
 
 struct AlgorithmParams
 {
+    SolverType solver = SimulatedAnnealingSolver;
     int maxExecutionTimeMs;
     InitialPathMode initialPathMode;
     NeighborMode neighborMode;
+    MoveProbabilities moveProbabilities;
     float coolingRate;
     float temperatureCoefficient;
+    CoolingParams cooling;
+    MoveBatchParams moveBatch;
+    TraceParams trace;
+    CheckpointParams checkpoint;
+    ParallelTemperingParams parallelTempering;
+    LocalSearchParams localSearch;
+    TabuSearchParams tabuSearch;
 
     AlgorithmParams(){};
 
@@ -31,14 +150,81 @@ struct AlgorithmParams
 
     void print()
     {
-        std::string initialPathModeStr = initialPathMode == Greedy ? "greedy" : "in order";
-        std::string neighborModeStr = neighborMode == Swap ? "swap" : "invert";
+        const char *initialPathModeNames[] = {"greedy", "in order", "nearest neighbor", "greedy edge", "MST doubling", "space-filling curve"};
+        std::string initialPathModeStr = initialPathModeNames[initialPathMode];
+        const char *neighborModeNames[] = {"swap", "invert", "or-opt", "or-2opt", "mixed"};
+        std::string neighborModeStr = neighborModeNames[neighborMode];
 
+        const char *solverNames[] = {"simulated annealing", "parallel tempering", "2-opt", "Lin-Kernighan", "tabu search"};
+
+        printf("Solver: %s\n", solverNames[solver]);
         printf("Max execution time: %i\n", maxExecutionTimeMs);
         printf("Initial path mode: %s\n", initialPathModeStr.c_str());
         printf("neighbor mode: %s\n", neighborModeStr.c_str());
+        if (neighborMode == Mixed)
+        {
+            printf("Move probabilities: swap %.2f, invert %.2f, or-opt %.2f, or-2opt %.2f\n",
+                   moveProbabilities.swap, moveProbabilities.invert, moveProbabilities.orOpt, moveProbabilities.or2Opt);
+        }
+        const char *scheduleNames[] = {"geometric", "Lundy-Mees", "Markov chain", "adaptive"};
+
+        printf("Cooling schedule: %s\n", scheduleNames[cooling.schedule]);
         printf("Cooling rate: %.4f\n", coolingRate);
-        printf("Temperature coefficient: %.4f\n", temperatureCoefficient);
+        if (cooling.schedule == MarkovChainCooling)
+        {
+            printf("Chain: %i * n iterations, cooling rate %.4f\n", cooling.chainLengthFactor, cooling.chainCoolingRate);
+        }
+        else if (cooling.schedule == LundyMeesCooling)
+        {
+            printf("Lundy-Mees coefficient: %g\n", cooling.lundyMeesCoefficient);
+        }
+        if (cooling.initialTemperatureMode == SampledTemperature)
+        {
+            printf("Initial temperature: sampled, acceptance %.2f\n", cooling.initialAcceptance);
+        }
+        else
+        {
+            printf("Temperature coefficient: %.4f\n", temperatureCoefficient);
+        }
+        if (cooling.reheatAfterFactor > 0)
+        {
+            printf("Reheating after %i * n iterations without improvement to %.2f * T0\n", cooling.reheatAfterFactor, cooling.reheatRatio);
+        }
+        if (moveBatch.size > 1)
+        {
+            printf("Move batches: %i candidates, best of batch below %g * T0\n", moveBatch.size, moveBatch.bestOfBatchRatio);
+        }
+        if (solver == ParallelTemperingSolver)
+        {
+            printf("Replicas: %i\n", parallelTempering.replicas);
+            printf("Temperature ratio: %g\n", parallelTempering.temperatureRatio);
+            printf("Exchange interval: %i\n", parallelTempering.exchangeInterval);
+        }
+        if (solver == TwoOptSolver || solver == LinKernighanSolver || localSearch.polish)
+        {
+            printf("Tour: %s\n", localSearch.tour == TwoLevelListTourType ? "two-level list" : "array");
+        }
+        if (solver == TwoOptSolver || localSearch.polish)
+        {
+            printf("2-opt: %i neighbors%s\n", localSearch.neighborCount, localSearch.polish ? ", polishing" : "");
+        }
+        if (solver == LinKernighanSolver)
+        {
+            printf("Lin-Kernighan: %i neighbors, depth %i, breadth %i\n", localSearch.neighborCount, localSearch.lkMaxDepth, localSearch.lkBreadth);
+        }
+        if (solver == TabuSearchSolver)
+        {
+            std::string tenureStr = tabuSearch.tenure > 0 ? std::to_string(tabuSearch.tenure) : "auto";
+            printf("Tabu search: %i neighbors, tenure %s, parallel from %i vertices\n", localSearch.neighborCount, tenureStr.c_str(), tabuSearch.parallelMinVertices);
+        }
+        if (trace.enabled)
+        {
+            printf("Trace: every %i iterations, every %i ms\n", trace.everyIters, trace.everyMs);
+        }
+        if (checkpoint.enabled)
+        {
+            printf("Checkpoint: every %i ms\n", checkpoint.everyMs);
+        }
     }
 };
 
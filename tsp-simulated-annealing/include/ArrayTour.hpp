@@ -0,0 +1,83 @@
+#ifndef ARRAY_TOUR_HPP
+#define ARRAY_TOUR_HPP
+
+#include <vector>
+
+/**
+ * @brief Tour stored as an array of vertices with the inverse array of their positions.
+ *
+ * The successor / predecessor of a vertex are found in O(1), reversing a part of the tour
+ * costs O(length of the part).
+ */
+class ArrayTour
+{
+private:
+    int size;
+    std::vector<int> tour;
+    // position[v] = index of vertex v in the tour
+    std::vector<int> position;
+    // If false, a part of the tour may be reversed by reversing the rest of the tour instead
+    bool keepOrientation;
+    // Buffer for rebuilding the tour
+    std::vector<int> buffer;
+
+    /**
+     * @brief Reverses the part of the tour between the positions `from` and `to` inclusive,
+     * going forward from `from` (the part may wrap around the end of the array)
+     */
+    void reverse(int from, int to);
+
+public:
+    /**
+     * @param keepOrientation true for directed graphs, where the orientation of the tour matters
+     */
+    ArrayTour(int size, bool keepOrientation);
+
+    void set(const int *path);
+
+    void copyTo(int *path);
+
+    int getSize() { return size; }
+
+    int next(int vertex)
+    {
+        const int index = position[vertex] + 1;
+        return tour[index == size ? 0 : index];
+    }
+
+    int prev(int vertex)
+    {
+        const int index = position[vertex];
+        return tour[index == 0 ? size - 1 : index - 1];
+    }
+
+    /**
+     * @brief Returns true if going forward from `a` one reaches `b` before (or at) `c`
+     */
+    bool between(int a, int b, int c)
+    {
+        const int ab = position[b] - position[a];
+        const int ac = position[c] - position[a];
+        return (ab < 0 ? ab + size : ab) <= (ac < 0 ? ac + size : ac);
+    }
+
+    /**
+     * @brief Replaces the edges (a, next(a)) and (c, next(c)) by (a, c) and (next(a), next(c)),
+     * reversing the part of the tour from next(a) to c
+     */
+    void twoOptMove(int a, int c);
+
+    /**
+     * @brief Moves the part of the tour from `first` to `last` (going forward) between `after` and next(after),
+     * keeping its orientation. Costs O(n).
+     */
+    void moveSegment(int first, int last, int after);
+
+    /**
+     * @brief Double bridge: for the vertices a, b, c in this order along the tour the parts
+     * [next(a) .. b] and [next(b) .. c] exchange their places, keeping their orientation. Costs O(n).
+     */
+    void doubleBridge(int a, int b, int c);
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AlgorithmParams.hpp"
+
+/**
+ * @brief The run of an instance test: the instance file, the results file and the run (of runCount) in progress
+ */
+struct CheckpointRun
+{
+    std::string instancePath;
+    std::string instanceName;
+    std::string outputPath;
+    int run = 0;
+    int runCount = 1;
+    AlgorithmParams params;
+};
+
+/**
+ * @brief Everything needed to continue an interrupted simulated annealing run
+ */
+struct SolverState
+{
+    CheckpointRun run;
+
+    // Execution time of the run so far [ms]
+    uint64_t elapsedMs = 0;
+    uint64_t rngState[2] = {0, 0};
+
+    int64_t iteration = 0;
+    int noImprovementIters = 0;
+    int initialPathWeight = 0;
+    int currentPathWeight = 0;
+    int bestFoundPathWeight = 0;
+
+    // Cooling schedule
+    double temperature = 0.0;
+    double initialTemperature = 0.0;
+    double lundyMeesBeta = 0.0;
+    int chainLength = 0;
+    int chainIteration = 0;
+    int chainAccepted = 0;
+    int reheatAfter = 0;
+    int stagnationIters = 0;
+    int reheatCount = 0;
+
+    std::vector<int> currentPath;
+    std::vector<int> bestFoundPath;
+};
+
+/**
+ * @brief Periodic checkpoints of the solver state in a compact binary file.
+ *
+ * save() only copies the state and wakes the writer thread, which writes the file
+ * while the solver goes on. Every checkpoint is written to a temporary file which then
+ * replaces the previous one, so an interruption never leaves a partially written checkpoint.
+ */
+class Checkpoint
+{
+private:
+    std::string filePath;
+    unsigned long everyMs = 0;
+    // Elapsed time of the run at which the next checkpoint is due
+    unsigned long nextMs = 0;
+    CheckpointRun run;
+
+    std::thread writer;
+    std::mutex mutex;
+    // Signaled when a state is pending or the writer is stopping
+    std::condition_variable stateAvailable;
+    // Signaled when the writer has written the pending state
+    std::condition_variable stateWritten;
+
+    // State filled by the solver, swapped with `writing` by the writer thread
+    SolverState pending;
+    SolverState writing;
+    bool hasPending = false;
+    bool isWriting = false;
+    bool stopping = false;
+
+    void runWriter();
+
+public:
+    Checkpoint() {}
+
+    ~Checkpoint();
+
+    /**
+     * @brief Starts the writer thread, the checkpoints are saved to `filePath` every `everyMs` ms of a run
+     */
+    void open(std::string filePath, int everyMs);
+
+    /**
+     * @brief Writes the pending state and stops the writer thread
+     */
+    void close();
+
+    bool isOpen() { return writer.joinable(); }
+
+    /**
+     * @brief Marks the beginning (or the resumption) of a run, resets the schedule of the checkpoints
+     */
+    void startRun(const CheckpointRun &run);
+
+    /**
+     * @brief Returns true when a checkpoint should be saved at this point of the run
+     * (`elapsedMs` is measured from the start or the resumption of the run)
+     */
+    bool isDue(unsigned long elapsedMs)
+    {
+        return elapsedMs >= nextMs;
+    }
+
+    /**
+     * @brief Lets `fill` copy the solver state for the writer thread and schedules the next checkpoint.
+     * Waits only for the writer to take the previous state, never for the file.
+     */
+    void save(unsigned long elapsedMs, const std::function<void(SolverState &)> &fill);
+
+    /**
+     * @brief Waits for the pending state to be written, then removes the checkpoint file
+     * (the run has been finished and its result saved)
+     */
+    void remove();
+
+    /**
+     * @brief Writes `state` to `filePath` (through a temporary file)
+     *
+     * @return false if the file could not be written
+     */
+    static bool write(std::string filePath, const SolverState &state);
+
+    /**
+     * @brief Reads the state from the checkpoint file
+     *
+     * @return false if the file could not be read or is not a checkpoint of this build
+     */
+    static bool read(std::string filePath, SolverState &state);
+};
+
+#endif
@@ -9,12 +9,21 @@ class FileUtils
 {
 public:
     /**
-     * @brief Loads graph from a file
+     * @brief Loads graph from a file: the instance name, the number of vertices n, n x n weights and the optimum (optional),
+     * or a TSPLIB file with node coordinates (EUC_2D, CEIL_2D, ATT or GEO), whose coordinates are kept in the graph.
+     * The file is memory-mapped and parsed in place.
      *
      * @param fileName Name of the file
-     * @return Pointer to the newly created graph
+     * @param error If not NULL, receives "<file>:<line>: <message>" when the file cannot be read
+     * @return Pointer to the newly created graph, NULL if the file is missing or invalid
      */
-    static GraphMatrix *loadGraph(std::string fileName);
+    static GraphMatrix *loadGraph(std::string fileName, std::string *error = NULL);
+
+    /**
+     * @brief Loads graph from a file through std::ifstream, without validation
+     * (the former loader, the reference of the loader benchmark)
+     */
+    static GraphMatrix *loadGraphWithStreams(std::string fileName);
 
     /**
      * @brief Writes header for the result file of single instance test
@@ -34,9 +43,64 @@ public:
      */
     static void appendTestResult(std::string filePath, TestResult testResult);
 
+    /**
+     * @brief Saves the row of a run of the single instance test which has not been run
+     * (`cancelled` instead of the path, the time, weight and error left empty)
+     */
+    static void appendCancelledTestResult(std::string filePath, std::string instanceName, int vertexCount);
+
     static void appendRandomInstanceTestResult(std::string filePath, int vertexCount, unsigned long elapsedTime);
     static void writeRandomInstanceTestHeader(std::string filePath);
 
+    /**
+     * @brief Writes header for the result file of the loader benchmark
+     *
+     * @param filePath Output file path
+     */
+    static void writeLoaderBenchmarkHeader(std::string filePath);
+
+    /**
+     * @brief Save a result of the loader benchmark
+     *
+     * @param streamTimeNs Average load time of loadGraphWithStreams()
+     * @param mmapTimeNs Average load time of loadGraph()
+     * @param cacheTimeNs Average load time of InstanceCache::read()
+     */
+    static void appendLoaderBenchmarkResult(std::string filePath, std::string instanceName, int vertexCount, long fileSize, unsigned long streamTimeNs, unsigned long mmapTimeNs, unsigned long cacheTimeNs);
+
+    /**
+     * @brief Writes header for the result file of the tour representation benchmark
+     *
+     * @param filePath Output file path
+     */
+    static void writeTourBenchmarkHeader(std::string filePath);
+
+    /**
+     * @brief Save a result of the tour representation benchmark
+     *
+     * @param tourName Name of the tour representation
+     * @param moveTimeNs Time of all the 2-opt moves
+     * @param queryTimeNs Time of all the next() / between() queries
+     */
+    static void appendTourBenchmarkResult(std::string filePath, std::string tourName, int vertexCount, int moveCount, unsigned long moveTimeNs, int queryCount, unsigned long queryTimeNs);
+
+    /**
+     * @brief Writes header for the result file of the solve context benchmark
+     *
+     * @param filePath Output file path
+     */
+    static void writeContextBenchmarkHeader(std::string filePath);
+
+    /**
+     * @brief Save a result of the solve context benchmark
+     *
+     * @param ownedTimeNs Time of all the constructions with buffers of their own
+     * @param reusedTimeNs Time of all the constructions with the reused context
+     * @param sortedCheckTimeNs Time of all the validity checks sorting a copy of the path
+     * @param bitsetCheckTimeNs Time of all the validity checks with the context bitset
+     */
+    static void appendContextBenchmarkResult(std::string filePath, int vertexCount, int repetitions, unsigned long ownedTimeNs, unsigned long reusedTimeNs, unsigned long sortedCheckTimeNs, unsigned long bitsetCheckTimeNs);
+
     /**
      * @brief Returns string representation of the path
      *
@@ -1,16 +1,26 @@
 #ifndef GRAPH_MATRIX2_H
 #define GRAPH_MATRIX2_H
 
+#include <cstddef>
+#include <string>
 #include <vector>
 
 // Graph representation using Adjacency Matrix
 class GraphMatrix
 {
 private:
-    int **matrix;
+    // Flat row-major matrix, row u starts at u * stride, every row is aligned to ROW_ALIGNMENT bytes
+    int *weights;
+    int stride;
     int size = 0;
+    // Memory mapping holding the weights (an instance cache file), NULL if the weights were allocated
+    void *mapping = NULL;
+    size_t mappingSize = 0;
 
 public:
+    // Name of the instance, empty for generated graphs
+    std::string name;
+
     bool optimumIsKnown = false;
 
     // By default graph is directed
@@ -18,6 +28,11 @@ public:
 
     // Weight of the optimal hamiltionian cycle
     int optimum = 0;
+
+    // Coordinates of the vertices, empty if the instance defines only the edge weights
+    std::vector<double> x;
+    std::vector<double> y;
+
     /**
      * @brief Construct a new Graph Matrix object
      *
@@ -25,6 +40,16 @@ public:
      */
     GraphMatrix(int size);
 
+    /**
+     * @brief Construct a Graph Matrix object over the weights of a memory mapping, unmapped by the destructor
+     *
+     * @param size size of the graph
+     * @param weights flat matrix with the stride of getStrideFor(size), aligned like an allocated one
+     * @param mapping the mapping holding the weights
+     * @param mappingSize size of the mapping in bytes
+     */
+    GraphMatrix(int size, int *weights, void *mapping, size_t mappingSize);
+
     ~GraphMatrix();
 
     void setOptimum(int optimum);
@@ -40,7 +65,7 @@ public:
     /**
      * @brief Adds a new edge to the graph from u to v, with weight 'weight'
      */
-    void addEdge(int u, int v, int weight);
+    void addEdge(int u, int v, int weight) { weights[(size_t)u * stride + v] = weight; }
 
     // Prints the Ajacency Matrix of the graph to stdout
     void display();
@@ -52,7 +77,20 @@ public:
     std::vector<int> getAdj(int v);
 
     // Returns weight of an egde from u to v
-    int getWeight(int u, int v);
+    int getWeight(int u, int v) { return weights[(size_t)u * stride + v]; }
+
+    // Returns the flat matrix, the weight from u to v is at u * getStride() + v
+    const int *getWeights() { return weights; }
+
+    int getStride() { return stride; }
+
+    // Returns the stride of the matrix of a graph of `size` vertices
+    static int getStrideFor(int size);
+
+    bool hasCoordinates() { return !x.empty(); }
+
+    // Returns true if the weight from u to v equals the weight from v to u for all the vertices
+    bool isSymmetric();
 };
 
 #endif
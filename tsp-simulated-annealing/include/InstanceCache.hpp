@@ -0,0 +1,56 @@
+#ifndef INSTANCE_CACHE_HPP
+#define INSTANCE_CACHE_HPP
+
+#include <string>
+
+#include "GraphMatrix.hpp"
+
+/**
+ * @brief Binary copies of the instance files, memory-mapped as the weight matrix of the graph.
+ *
+ * A cache file holds a fixed size header (the instance name, the number of vertices, the weight type,
+ * the symmetry of the weights, the optimum, the size and modification time of the instance file and
+ * checksums) followed by the weight matrix exactly as GraphMatrix stores it, rows padded and aligned,
+ * and by the vertex coordinates of a TSPLIB instance.
+ * Loading a cached instance only maps the file, without parsing or copying the weights, and the
+ * processes loading the same instance share the pages of the matrix.
+ */
+class InstanceCache
+{
+public:
+    /**
+     * @brief Loads the instance from its cache file in `cacheDir`. If the cache file is missing or does not
+     * match the instance file, the instance file is parsed by FileUtils::loadGraph() and the cache file written.
+     *
+     * @param instancePath Path of the instance file
+     * @param cacheDir Directory of the cache files (created if missing), empty to parse the instance file only
+     * @param error If not NULL, receives the error message when the instance cannot be loaded
+     * @return Pointer to the newly created graph, NULL if the instance file is missing or invalid
+     */
+    static GraphMatrix *load(std::string instancePath, std::string cacheDir, std::string *error = NULL);
+
+    /**
+     * @brief Returns the path of the cache file of the instance, named after the instance file and
+     * the hash of its absolute path
+     */
+    static std::string cachePath(std::string instancePath, std::string cacheDir);
+
+    /**
+     * @brief Writes the graph of the instance file to `cachePath` (through a temporary file)
+     *
+     * @return false if the file could not be written
+     */
+    static bool write(std::string cachePath, std::string instancePath, GraphMatrix *graph);
+
+    /**
+     * @brief Maps the cache file written for the instance file
+     *
+     * @param verifyWeights true to check the checksum of the weights as well, which reads the whole matrix
+     * (the header is always checked)
+     * @return Pointer to the newly created graph, NULL if the file is missing, invalid or was written for
+     * another version of the instance file
+     */
+    static GraphMatrix *read(std::string cachePath, std::string instancePath, bool verifyWeights = false);
+};
+
+#endif
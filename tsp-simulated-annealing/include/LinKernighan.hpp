@@ -0,0 +1,119 @@
+#ifndef LIN_KERNIGHAN_HPP
+#define LIN_KERNIGHAN_HPP
+
+#include <vector>
+
+#include "GraphMatrix.hpp"
+#include "TSPAlgorithm.hpp"
+#include "AlgorithmParams.hpp"
+#include "NeighborLists.hpp"
+#include "ArrayTour.hpp"
+#include "TwoLevelListTour.hpp"
+#include "Path.hpp"
+
+/**
+ * @brief Chained Lin-Kernighan style local search.
+ *
+ * An LK move is a chain of 2-opt moves sharing the vertex t1: after every step the tour is
+ * closed again, so the chain can be cut at its best step. The next edge of the chain is
+ * chosen from the neighbor lists while the cumulative gain stays positive (up to `lkMaxDepth`
+ * steps, `lkBreadth` alternatives of the first step). Vertices have don't-look bits like in
+ * the 2-opt search.
+ *
+ * Directed graphs use Or-opt instead (segments of 1-3 vertices moved without reversal),
+ * since reversing a part of an asymmetric tour changes its weight.
+ *
+ * The local optimum is perturbed by a random double bridge and improved again until the
+ * end criterion is met; a worse result is reverted to the best path.
+ *
+ * `Tour` is ArrayTour or TwoLevelListTour (instantiated in LinKernighan.cpp).
+ */
+template <class Tour>
+class LinKernighan : public TSPAlgorithm
+{
+private:
+    NeighborLists neighbors;
+    Tour tour;
+    int maxDepth;
+    int breadth;
+
+    // Vertices with the don't-look bit off, waiting to be looked at (FIFO ring buffer)
+    std::vector<int> queue;
+    std::vector<char> queued;
+    int queueHead = 0;
+    int queueCount = 0;
+
+    // Orientation of the tour during an LK move: the successor of a vertex is next() if true, prev() otherwise
+    bool forward = true;
+    // Vertices added as t3 during the current LK move are marked with the move stamp
+    std::vector<int> usedStamp;
+    int stamp = 0;
+    // t3 of every step of the current LK move (for undoing the steps)
+    std::vector<int> steps;
+
+    int iteration = 0;
+    long kickCount = 0;
+    bool timeLimitReached = false;
+
+    int succ(int vertex) { return forward ? tour.next(vertex) : tour.prev(vertex); }
+    int pred(int vertex) { return forward ? tour.prev(vertex) : tour.next(vertex); }
+
+    // Turns the don't-look bit of `vertex` off
+    void activate(int vertex);
+
+    /**
+     * @brief Replaces the edges (t1, t2) and (t4, t3) by (t1, t4) and (t2, t3),
+     * where t2 = succ(t1) and t4 = pred(t3), and updates the orientation so that succ(t1) = t4
+     */
+    void flip(int t1, int t2, int t3, int t4);
+
+    /**
+     * @brief Tries an LK move starting with the removal of the edge (t1, succ(t1)),
+     * applies the best closed tour of the chain if it is shorter
+     *
+     * @return true if the tour has been improved
+     */
+    bool improveLK(int t1);
+
+    /**
+     * @brief Extends the LK move from the free end `t2` greedily as long as the gain stays positive
+     *
+     * @param gain Weight of the removed minus the weight of the added edges (without closing the tour)
+     * @param bestGain The best gain of a closed tour found so far, updated
+     * @param bestStep The number of steps of the best closed tour, updated
+     */
+    void extendLK(int t1, int t2, int gain, int &bestGain, int &bestStep);
+
+    /**
+     * @brief Undoes the steps of the current LK move until `stepCount` steps are left
+     */
+    void undoSteps(int t1, int stepCount);
+
+    /**
+     * @brief Tries to move the segment of 1-3 vertices starting at `first` between two vertices
+     * (without reversing it), applies the first improving move
+     *
+     * @return true if the tour has been improved
+     */
+    bool improveOrOpt(int first);
+
+    /**
+     * @brief Improves the tour until no vertex has the don't-look bit off
+     *
+     * @return false if the execution time limit has been reached
+     */
+    bool descend();
+
+    // Perturbs the tour with a random double bridge
+    void kick();
+
+public:
+    LinKernighan(GraphMatrix *graph, AlgorithmParams params);
+
+    /**
+     * @brief Solves the Traveling Salesman Problem using chained Lin-Kernighan style local search
+     */
+    Path solveTSP();
+};
+
+#endif
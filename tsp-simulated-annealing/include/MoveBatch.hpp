@@ -0,0 +1,30 @@
+#ifndef MOVE_BATCH_HPP
+#define MOVE_BATCH_HPP
+
+#include "GraphMatrix.hpp"
+
+/**
+ * @brief Weight changes of a batch of candidate moves of a path, computed at once.
+ *
+ * A move is given by two path indices 1 <= first[k] < last[k] <= n - 1 (as drawn by the simulated
+ * annealing). With AVX2 eight moves are evaluated together: the vertices and the edge weights are
+ * gathered from the path and from the flat weight matrix. Other CPUs use the scalar loop.
+ */
+class MoveBatch
+{
+public:
+    /**
+     * @brief Weight changes of reversing the parts [first[k], last[k]] of the path (undirected graphs only)
+     */
+    static void invertDeltas(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas);
+
+    /**
+     * @brief Weight changes of swapping the vertices at first[k] and last[k]
+     */
+    static void swapDeltas(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas);
+
+    // Returns true if the batches are evaluated with AVX2
+    static bool usesAvx2();
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef NEIGHBOR_LISTS_HPP
+#define NEIGHBOR_LISTS_HPP
+
+#include <vector>
+
+#include "GraphMatrix.hpp"
+
+/**
+ * @brief Candidate lists: the k nearest vertices of every vertex, sorted by the edge weight.
+ *
+ * Local search only tries new edges to the candidates of a vertex, so a pass over the path
+ * costs O(n * k) instead of O(n^2).
+ */
+class NeighborLists
+{
+private:
+    int vertexCount;
+    int count;
+    // count neighbors of vertex v at [v * count, (v + 1) * count)
+    std::vector<int> neighbors;
+
+public:
+    /**
+     * @brief Builds the lists of the `k` nearest vertices (by the weight of the outgoing edge)
+     */
+    NeighborLists(GraphMatrix *graph, int k);
+
+    // Returns the number of neighbors of every vertex
+    int getCount() { return count; }
+
+    // Returns the neighbors of `vertex`, the nearest first
+    const int *get(int vertex) { return &neighbors[vertex * count]; }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PARALLEL_TEMPERING_HPP
+#define PARALLEL_TEMPERING_HPP
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "GraphMatrix.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "SharedBest.hpp"
+#include "AlgorithmParams.hpp"
+#include "Path.hpp"
+#include "Random.hpp"
+#include "Timer.hpp"
+#include "Trace.hpp"
+
+/**
+ * @brief Replica exchange (parallel tempering) simulated annealing.
+ *
+ * Every replica is a Markov chain running on its own thread at one temperature of a geometric ladder.
+ * After every `exchangeInterval` iterations the replicas meet at a barrier and the last one to arrive
+ * attempts to exchange the states of the replicas at adjacent temperatures. An exchange only swaps the
+ * temperatures of the two replicas, the paths stay where they are.
+ */
+class ParallelTempering
+{
+private:
+    GraphMatrix *graph;
+    AlgorithmParams params;
+
+    int replicaCount;
+    std::vector<SimulatedAnnealing *> replicas;
+
+    // Temperatures of the ladder, from the highest to the lowest
+    std::vector<double> ladder;
+    // Index of the replica at each level of the ladder
+    std::vector<int> replicaAtLevel;
+    // Level of the ladder of each replica
+    std::vector<int> levelOfReplica;
+
+    SharedBest best;
+
+    // Used only by the replica performing the exchange
+    Random rng;
+    int exchangeRound = 0;
+    long exchangeAttempts = 0;
+    long exchangesAccepted = 0;
+
+    // Barrier at which the replicas meet between the chains
+    std::mutex barrierMutex;
+    std::condition_variable barrierCondition;
+    int waitingCount = 0;
+    unsigned long barrierGeneration = 0;
+    // Set by a replica which has reached the execution time limit
+    bool stop = false;
+    // Decision taken at the last barrier
+    bool keepRunning = true;
+
+    Timer timer;
+    Trace *trace = NULL;
+
+    /**
+     * @brief Runs the chains of the replica until the execution time limit is reached
+     */
+    void runReplica(int replicaIndex);
+
+    /**
+     * @brief Waits until all the replicas finish their chains, the last one performs the exchange
+     *
+     * @param timeLimitReached true if the calling replica has reached the execution time limit
+     * @return false if the algorithm should stop
+     */
+    bool synchronize(bool timeLimitReached);
+
+    /**
+     * @brief Attempts to exchange the states of the replicas at adjacent levels of the ladder
+     * (alternately the even and the odd pairs)
+     */
+    void exchangeStates();
+
+    /**
+     * @brief Builds the geometric temperature ladder
+     */
+    void initLadder(double maxTemperature);
+
+public:
+    ParallelTempering(GraphMatrix *graph, AlgorithmParams params);
+
+    ~ParallelTempering();
+
+    /**
+     * @brief Sets the trace, sampled by the coordinating replica at the exchanges
+     */
+    void setTrace(Trace *trace);
+
+    /**
+     * @brief Solves the Traveling Salesman Problem using replica exchange simulated annealing
+     */
+    Path solveTSP();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+/**
+ * @brief Small, fast pseudo random number generator (xorshift128+).
+ *
+ * Every algorithm instance owns its generator, so instances running on different threads
+ * neither share nor lock a global state (as rand() / random() do).
+ */
+class Random
+{
+private:
+    uint64_t state[2];
+
+public:
+    Random(uint64_t seed = 1)
+    {
+        setSeed(seed);
+    }
+
+    /**
+     * @brief Initializes the state from `seed` using splitmix64
+     */
+    void setSeed(uint64_t seed)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+
+    /**
+     * @brief Copies the state of the generator (to be restored by setState())
+     */
+    void getState(uint64_t state[2]) const
+    {
+        state[0] = this->state[0];
+        state[1] = this->state[1];
+    }
+
+    void setState(const uint64_t state[2])
+    {
+        this->state[0] = state[0];
+        this->state[1] = state[1];
+    }
+
+    uint64_t next()
+    {
+        uint64_t s1 = state[0];
+        const uint64_t s0 = state[1];
+        state[0] = s0;
+        s1 ^= s1 << 23;
+        state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+        return state[1] + s0;
+    }
+
+    /**
+     * @brief Returns a random int [0, bound)
+     */
+    int nextInt(int bound)
+    {
+        return (int)(((next() >> 32) * (uint64_t)bound) >> 32);
+    }
+
+    /**
+     * @brief Returns a random double [0.0, 1.0)
+     */
+    double nextDouble()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+#endif
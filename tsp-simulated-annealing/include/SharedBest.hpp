@@ -0,0 +1,61 @@
+#ifndef SHARED_BEST_HPP
+#define SHARED_BEST_HPP
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief The best path found by any of the algorithm instances running in parallel.
+ *
+ * The weight can be read without locking; the mutex is taken only when a path
+ * which is better than the current best one is offered.
+ * Once a path not longer than the target weight is offered, the target is reached
+ * and the instances should stop.
+ */
+class SharedBest
+{
+private:
+    std::mutex mutex;
+    std::atomic<int> weight;
+    std::vector<int> path;
+
+    int target = INT_MIN;
+    std::atomic<bool> targetReached;
+
+public:
+    SharedBest() : weight(INT_MAX), targetReached(false) {}
+
+    /**
+     * @brief Sets the weight (e.g. the known optimum) at which the instances should stop
+     */
+    void setTarget(int target)
+    {
+        this->target = target;
+    }
+
+    bool isTargetReached()
+    {
+        return targetReached.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the weight of the best path (INT_MAX if none has been offered yet)
+     */
+    int getWeight()
+    {
+        return weight.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Replaces the best path with `path` if it is shorter
+     *
+     * @return true if the best path has been replaced
+     */
+    bool offer(const int *path, int size, int weight);
+
+    std::vector<int> getPath();
+};
+
+#endif
@@ -9,22 +9,81 @@
 #include "TSPAlgorithm.hpp"
 #include "Path.hpp"
 #include "AlgorithmParams.hpp"
+#include "Checkpoint.hpp"
 
 class SimulatedAnnealing : public TSPAlgorithm
 {
 private:
     float coolingRate;
     float temperatureCoefficient;
+    CoolingParams cooling;
 
-    // The iteration number
-    int iteration;
+    // The iteration number (a run reaches 2^31 iterations in a few minutes)
+    long long iteration;
+
+    double temperature;
+    double initialTemperature;
+    // Lundy-Mees: T = T / (1 + beta * T)
+    double lundyMeesBeta;
+    // Markov chain / adaptive cooling: iterations per temperature level and the progress of the current chain
+    int chainLength;
+    int chainIteration;
+    int chainAccepted;
+    // Iterations without improvement since the last improvement or reheat (0 disables reheating)
+    int reheatAfter;
+    int stagnationIters;
+    int reheatCount;
+
+    // Candidate moves evaluated at once (batchSize = 0 if the moves are evaluated one by one)
+    int batchSize = 0;
+    double bestOfBatchRatio;
+    // Arrays of the solve context
+    int *batchFirst;
+    int *batchLast;
+    int *batchDeltas;
+    // The next candidate of the batch to be tried
+    int batchPosition = 0;
+    // Path positions changed by the moves accepted since the batch was evaluated (empty if first > last)
+    int changedFirst;
+    int changedLast;
+
+    // Optional checkpoints of the state (NULL when checkpointing is disabled)
+    Checkpoint *checkpoint = NULL;
+    // true if the state has been restored from a checkpoint, the run then continues instead of starting
+    bool resumed = false;
+    // Execution time of the run before it was resumed [ms]
+    unsigned long resumedElapsedMs = 0;
 
     /**
-     * @brief Calculates and returns the initial temperature
+     * @brief Hands a copy of the state to the checkpoint writer
+     */
+    void saveCheckpoint();
+
+    /**
+     * @brief Estimates the initial temperature from the weight changes of a sample of random moves
+     * of the current path, so that an average worsening move is accepted with `initialAcceptance`
      *
-     * @return The calculated initial temperature
+     * @return The temperature, or 0.0 if none of the sampled moves was worsening
      */
-    double getInitialTemperature();
+    double getSampledInitialTemperature();
+
+    /**
+     * @brief Sets the initial temperature and resets the state of the cooling schedule
+     */
+    void startCooling();
+
+    /**
+     * @brief Updates the temperature after an iteration according to the cooling schedule
+     *
+     * @param accepted true if the candidate path of the iteration has been accepted
+     */
+    void updateTemperature(bool accepted);
+
+    /**
+     * @brief Adjusts the temperature at the end of a chain so that the acceptance ratio
+     * follows the target of the adaptive schedule
+     */
+    void adaptTemperature();
 
     /**
      * @brief Calculates and returns the average of the graph edge weight
@@ -43,19 +102,86 @@ public:
      * @brief Construct a new Simulated Annealing object
      *
      * @param graph The graph on which the algorithm is executed.
+     * @param context Working memory reused by the runs of one thread (NULL = owned by this instance)
      */
-    SimulatedAnnealing(GraphMatrix *graph, AlgorithmParams params);
+    SimulatedAnnealing(GraphMatrix *graph, AlgorithmParams params, SolveContext *context = NULL);
 
     /**
      * @brief Solves the Traveling Salesman Problem using the Simulated Anealing algorithm.
      */
     Path solveTSP();
 
+    /**
+     * @brief Sets the checkpoint to which the state is saved periodically while solving
+     */
+    void setCheckpoint(Checkpoint *checkpoint);
+
+    /**
+     * @brief Restores the state saved in a checkpoint, solveTSP() then continues the saved run
+     * for the rest of its execution time. The paths of `state` must be paths of this graph.
+     */
+    void resume(const SolverState &state);
+
+    /**
+     * @brief Sets the initial path and resets the iteration counters
+     */
+    void initialize();
+
+    /**
+     * @brief Performs `steps` iterations at the constant `temperature` (a Markov chain of the
+     * Metropolis algorithm). Used by the replicas of the parallel tempering.
+     * The execution time limit must be started with startTimer().
+     *
+     * @return false if the execution time limit has been reached
+     */
+    bool runChain(int steps, double temperature);
+
+    /**
+     * @brief Returns the best path found so far
+     */
+    Path getBestFoundPath();
+
+    /**
+     * @brief Calculates and returns the initial temperature (sampled or from the AAD of the edge weights).
+     * The initial path must be set with initialize().
+     *
+     * @return The calculated initial temperature
+     */
+    double getInitialTemperature();
+
     /**
      * @brief Gets the new path permutation
      */
     void getNextPathPermutation();
 
+    /**
+     * @brief Gets the next move from the batch of candidates, evaluating a new batch when the previous
+     * one is used up. Candidates made stale by the accepted moves are evaluated again one by one.
+     * At temperatures below bestOfBatchRatio * T0 every call evaluates a new batch and gets its best move.
+     */
+    void getNextBatchedMove();
+
+    /**
+     * @brief Draws a batch of random candidate moves and computes their weight changes
+     */
+    void evaluateBatch();
+
+    /**
+     * @brief Returns true if the vertices which determine the weight change of the candidate move
+     * (the ends of the moved parts and their neighbors) were moved by the accepted moves
+     */
+    bool isStale(int first, int last);
+
+    /**
+     * @brief Gets a random move of a segment of `length` vertices
+     */
+    void getSegmentMove(int length, bool reversed, NeighborMode mode);
+
+    /**
+     * @brief Draws the neighbor mode of the next move according to the move probabilities
+     */
+    NeighborMode drawNeighborMode();
+
     /**
      * @brief Returns the probability of making the transition from the currentPath to a candidate nextPath
      *
@@ -0,0 +1,73 @@
+#ifndef SOLVE_CONTEXT_HPP
+#define SOLVE_CONTEXT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Working memory of an algorithm run, reused by the consecutive runs of one thread
+ * instead of being allocated for every run.
+ *
+ * The buffers only grow: a run on a graph not larger than the previous ones allocates nothing.
+ * A context may be used by one algorithm at a time.
+ */
+class SolveContext
+{
+public:
+    std::vector<int> currentPath;
+    std::vector<int> bestFoundPath;
+    // One bit per vertex: the visited vertices of the greedy path, the vertices seen by the path validity check
+    std::vector<uint64_t> vertexBits;
+
+    // Candidate moves of the batched simulated annealing
+    std::vector<int> batchFirst;
+    std::vector<int> batchLast;
+    std::vector<int> batchDeltas;
+
+    /**
+     * @brief Makes room for the paths of `vertexCount` vertices
+     */
+    void reserve(int vertexCount)
+    {
+        if ((int)currentPath.size() < vertexCount)
+        {
+            currentPath.resize(vertexCount);
+            bestFoundPath.resize(vertexCount);
+            vertexBits.resize((vertexCount + 63) / 64);
+        }
+    }
+
+    /**
+     * @brief Makes room for `size` candidate moves
+     */
+    void reserveBatch(int size)
+    {
+        if ((int)batchFirst.size() < size)
+        {
+            batchFirst.resize(size);
+            batchLast.resize(size);
+            batchDeltas.resize(size);
+        }
+    }
+
+    /**
+     * @brief Clears the bits of the vertices 0 .. vertexCount - 1
+     */
+    void clearVertexBits(int vertexCount)
+    {
+        std::fill(vertexBits.begin(), vertexBits.begin() + (vertexCount + 63) / 64, 0);
+    }
+
+    bool isVertexSet(int vertex) const
+    {
+        return (vertexBits[vertex >> 6] >> (vertex & 63)) & 1;
+    }
+
+    void setVertex(int vertex)
+    {
+        vertexBits[vertex >> 6] |= (uint64_t)1 << (vertex & 63);
+    }
+};
+
+#endif
@@ -7,17 +7,69 @@
 #include <cmath>
 #include <chrono>
 #include "Timer.hpp"
+#include "Trace.hpp"
+#include "Random.hpp"
+#include "SharedBest.hpp"
+#include "NeighborLists.hpp"
+#include "SolveContext.hpp"
 
 enum InitialPathMode
 {
+    // Nearest neighbor scanning all the vertices, O(n^2)
     Greedy,
     InOrder,
+    // Nearest neighbor over the candidate lists
+    NearestNeighbor,
+    // Greedy edge matching over the candidate edges
+    GreedyEdge,
+    // Preorder walk of the minimum spanning tree of the candidate edges
+    MstDoubling,
+    // Hilbert curve order of the vertex coordinates of a TSPLIB instance (nearest neighbor if the graph has none)
+    SpaceFillingCurve,
 };
 
 enum NeighborMode
 {
     Swap,
     Invert,
+    // Moves a segment of 1-3 vertices to another place of the path, optionally reversed
+    OrOpt,
+    // Restricted 3-opt: moves a segment of any length to another place of the path
+    Or2Opt,
+    // Draws one of the above moves according to MoveProbabilities
+    Mixed,
+};
+
+// Probabilities of the moves in the Mixed neighbor mode (need not sum up to 1)
+struct MoveProbabilities
+{
+    double swap = 0.0;
+    double invert = 0.5;
+    double orOpt = 0.5;
+    double or2Opt = 0.0;
+};
+
+// A move transforming the current path into the next path
+struct Move
+{
+    NeighborMode mode;
+    // Swap / Invert: the swapped vertices / the ends of the inverted part
+    // OrOpt / Or2Opt: the first and the last index of the segment, the segment is moved after index3
+    int index1;
+    int index2;
+    int index3;
+    bool reversed;
+
+    Move() {}
+
+    Move(NeighborMode mode, int index1, int index2, int index3 = 0, bool reversed = false)
+    {
+        this->mode = mode;
+        this->index1 = index1;
+        this->index2 = index2;
+        this->index3 = index3;
+        this->reversed = reversed;
+    }
 };
 
 class TSPAlgorithm
@@ -25,11 +77,14 @@ class TSPAlgorithm
 protected:
     GraphMatrix *graph;
     int graphSize;
+    // Working memory of the run: the context passed to the constructor, or ownedContext
+    SolveContext *context;
+    SolveContext ownedContext;
     // Array holding the vertices of the current path
     int *currentPath = NULL;
     int currentPathWeight;
-    // Array holding the vertices of the next permutation of this path
-    int *nextPath = NULL;
+    // The move leading to the next permutation of this path and the weight of that permutation
+    Move nextMove;
     int nextPathWeight;
 
     // Array holding the best found path yet
@@ -47,14 +102,34 @@ protected:
 
     Timer timer;
 
+    // Number of iterations between two reads of the clock, calibrated while the algorithm runs
+    int timeCheckInterval = 1;
+    int itersUntilTimeCheck = 1;
+    // Elapsed time at the last read of the clock
+    unsigned long lastTimeCheckNs = 0;
+    unsigned long elapsedMs = 0;
+
+    // Optional progress trace (NULL when tracing is disabled)
+    Trace *trace = NULL;
+
+    // Best path shared with the instances running in parallel (NULL when running alone)
+    SharedBest *sharedBest = NULL;
+
+    // Random number generator of this instance
+    Random rng;
+
     // Algorithm params
     int maxNoImprovementIters;
     int maxExecutionTime;
     InitialPathMode initialPathMode;
     NeighborMode neighborMode;
+    MoveProbabilities moveProbabilities;
+
+    // Candidate lists of the subclass used by the construction of the initial path (NULL = built when needed)
+    NeighborLists *constructionNeighbors = NULL;
 
     /**
-     * @brief Sets the initial path
+     * @brief Sets the initial path, prints its weight and construction time (only when running alone, without a shared best path)
      */
     void setInitialPath();
 
@@ -69,30 +144,43 @@ protected:
      */
     void initialPathGreedy();
 
+    /**
+     * @brief Sets the initial path using one of the construction heuristics working with the candidate lists
+     */
+    void initialPathFromCandidates();
+
     int getCurrentPathWeight();
 
     int randomPathIndex();
 
-    // Returns true if the next path is equal to current path
-    bool nextPathEqualToCurrent();
+    // Returns the index following / preceding `index` in the (cyclic) path
+    int nextIndex(int index);
+    int prevIndex(int index);
 
-    // Gets the new path by inverteing a path between index1 and index2 inclusive
+    // Gets the next move: inverting the path between index1 and index2 inclusive
     void invert(int index1, int index2);
 
-    // Gets the new path by swaping vertex at index1 with vertex at index2
+    // Gets the next move: swapping vertex at index1 with vertex at index2
     void swap(int index1, int index2);
 
     /**
-     * @brief Returns the edge weight between vertices from currentPath
-     * at indices index1 and index2
+     * @brief Gets the next move: moving the segment [first, last] between the vertices
+     * at `index` and `index + 1`, optionally reversed (1 <= first <= last, index outside [first - 1, last]).
+     * The weight change is computed in O(1) (O(segment length) for a reversed segment of a directed graph).
      */
-    int getWeight(int index1, int index2);
+    void moveSegment(int first, int last, int index, bool reversed, NeighborMode mode);
 
     /**
-     * @brief Returns the edge weight between vertices from nextPath
+     * @brief Applies `nextMove` to the current path (in place)
+     */
+    void applyNextMove();
+
+    /**
+     * @brief Returns the edge weight between vertices from currentPath
      * at indices index1 and index2
      */
-    int getNextWeight(int index1, int index2);
+    int getWeight(int index1, int index2);
+
 
     void printPath(int *path);
 
@@ -109,14 +197,22 @@ protected:
     /**
      * @brief Checks if the end criterion is met
      *
+     * The clock is read only every `timeCheckInterval` calls, see calibrateTimeCheckInterval()
+     *
      * @return true if the end criterion is met otherwise false
      */
     bool endCriterionIsMet();
 
+    /**
+     * @brief Adjusts the number of iterations between clock reads,
+     * so that the clock is read roughly every TIME_CHECK_PERIOD_NS
+     */
+    void calibrateTimeCheckInterval(unsigned long elapsedNs);
+
     /**
      * @brief Prints 'iteration' number, 'pathWeight' and percentage difference between `pathWeight` and the optimum.
      */
-    void printImprovement(int iteration, int pathWeight);
+    void printImprovement(long long iteration, int pathWeight);
 
     /**
      * @brief Returns true when the limit of the number of iterations without improvement has been reached,
@@ -136,13 +232,39 @@ protected:
     float getPrd(int pathWeight);
 
 public:
-    TSPAlgorithm(GraphMatrix *graph);
+    /**
+     * @param context Working memory reused by the runs of one thread (NULL = owned by this algorithm)
+     */
+    TSPAlgorithm(GraphMatrix *graph, SolveContext *context = NULL);
 
-    ~TSPAlgorithm();
+    /**
+     * @brief Sets the trace to which the progress of the algorithm is sampled
+     */
+    void setTrace(Trace *trace);
+
+    /**
+     * @brief Sets the best path shared with the instances running in parallel.
+     * Improvements are printed only when they improve the shared best path.
+     */
+    void setSharedBest(SharedBest *sharedBest);
+
+    void setSeed(uint64_t seed);
+
+    /**
+     * @brief Starts measuring the execution time of the algorithm
+     */
+    void startTimer();
+
+    int getCurrentWeight() { return currentPathWeight; }
+
+    int getBestWeight() { return bestFoundPathWeight; }
 
     int getGreedyPathWeight();
 
     int getInOrderPathWeight();
+    /**
+     * @brief Returns true if `path` visits every vertex exactly once, O(n)
+     */
     bool pathIsValid(int *path);
 };
 
@@ -0,0 +1,150 @@
+#ifndef TABU_SEARCH_HPP
+#define TABU_SEARCH_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "GraphMatrix.hpp"
+#include "TSPAlgorithm.hpp"
+#include "AlgorithmParams.hpp"
+#include "NeighborLists.hpp"
+#include "ArrayTour.hpp"
+#include "ThreadPool.hpp"
+#include "Path.hpp"
+
+/**
+ * @brief Tabu search.
+ *
+ * Every iteration applies the best admissible move of the candidate neighborhood, even if it makes
+ * the path longer. The moves add an edge from a vertex to one of its candidates: a 2-opt move
+ * (undirected graphs only) or the insertion of the candidate after the vertex. The weight change
+ * of every move is computed in O(1) from the edges it removes and adds.
+ *
+ * The edges removed by a move are tabu for `tenure` iterations: a move adding a tabu edge is
+ * admissible only if it leads to a path shorter than the best one found (aspiration). The tabu
+ * status is kept in an n x n matrix of iteration stamps, so the check is O(1).
+ *
+ * The neighborhood is updated incrementally. The best non-tabu and the best tabu move of every vertex
+ * are kept in two minimum trees; a vertex is evaluated again only when the prev / next of itself or of
+ * one of its candidates has changed, or the tabu status of an edge its moves add has changed (set or expired).
+ * Only the best tabu move of the whole neighborhood can aspire, so the best admissible move is read from
+ * the roots of the trees in O(1) and every re-evaluated vertex costs O(k + log n).
+ *
+ * For large graphs many re-evaluated vertices are split into batches evaluated in parallel on a thread pool.
+ */
+class TabuSearch : public TSPAlgorithm
+{
+private:
+    enum MoveType
+    {
+        // Adds the edges (a, c) and (succ(a), succ(c)), succ = next if `successor`, otherwise prev
+        TwoOptMove,
+        // Moves c between a and next(a)
+        InsertMove,
+    };
+
+    struct TabuMove
+    {
+        MoveType type;
+        int a;
+        int c;
+        bool successor;
+        int delta = INT_MAX;
+    };
+
+    // The moves of a vertex with one of its candidates, in the order of evaluation
+    enum MoveKind
+    {
+        SuccessorTwoOpt,
+        PredecessorTwoOpt,
+        Insertion,
+        MOVE_KIND_COUNT,
+    };
+
+    // Key of a move, ordered by the weight change and then by the order of evaluation (vertex, candidate, kind)
+    typedef uint64_t MoveKey;
+    static const MoveKey NO_MOVE = UINT64_MAX;
+
+    NeighborLists neighbors;
+    ArrayTour tour;
+    // Vertices having `v` among their candidates: reverseNeighbors[reverseStart[v] .. reverseStart[v + 1])
+    std::vector<int> reverseNeighbors;
+    std::vector<int> reverseStart;
+
+    // tabuUntil[u * n + v] = the first iteration in which the edge (u, v) may be added again
+    std::vector<int> tabuUntil;
+    // The edges (u * n + v) whose tabu status may end in iteration i are in expiring[i % expiring.size()]
+    std::vector<std::vector<int>> expiring;
+    int tenure;
+    int iteration = 0;
+
+    // Minimum trees of the best non-tabu / tabu move of every vertex, the leaf of vertex v at leafCount + v
+    int leafCount;
+    std::vector<MoveKey> allowedTree;
+    std::vector<MoveKey> tabuTree;
+
+    // Vertices whose moves have to be evaluated again
+    std::vector<int> dirtyVertices;
+    std::vector<char> isDirty;
+
+    // Evaluates many dirty vertices in parallel (NULL for small graphs)
+    ThreadPool *pool = NULL;
+
+    bool isTabu(int u, int v) { return tabuUntil[u * graphSize + v] > iteration; }
+
+    // Makes adding the edge (u, v) tabu, the vertices whose moves add it are evaluated again
+    void setTabu(int u, int v);
+
+    // Marks the vertices whose moves add the edges of the tabu status ending in this iteration
+    void releaseExpiredTabu();
+
+    // Returns true if a move with the weight change `delta` leads to a path shorter than the best one (aspiration)
+    bool aspires(int delta) { return currentPathWeight + delta < bestFoundPathWeight; }
+
+    MoveKey moveKey(int delta, int a, int candidate, MoveKind kind);
+
+    // Decodes the move of the key
+    TabuMove getMove(MoveKey key);
+
+    // Marks `vertex` and the vertices having it as a candidate: the prev / next of `vertex` have changed
+    void markChanged(int vertex);
+
+    // Marks the vertices whose moves may add an edge of `vertex`: those of the vertex and its prev / next
+    void markAround(int vertex);
+
+    // Evaluates the moves of vertex `a` into its leaves of the trees
+    void evaluateVertex(int a);
+
+    /**
+     * @brief Evaluates the dirty vertices [from, to) of `dirtyVertices`
+     */
+    void evaluateBatch(int from, int to);
+
+    // Evaluates the dirty vertices and updates the trees
+    void evaluateDirtyVertices();
+
+    // Returns the best admissible move of the whole neighborhood
+    TabuMove findBestMove();
+
+    /**
+     * @brief 2-opt move of the tour reversing the part from next(x) to y, marks the vertices whose prev / next
+     * have changed: the ends of the replaced edges and the part of the tour reversed by the array
+     */
+    void twoOptMove(int x, int y);
+
+    // Applies the move and makes the removed edges tabu
+    void applyMove(const TabuMove &move);
+
+public:
+    TabuSearch(GraphMatrix *graph, AlgorithmParams params);
+
+    ~TabuSearch();
+
+    /**
+     * @brief Solves the Traveling Salesman Problem using tabu search
+     */
+    Path solveTSP();
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed number of worker threads executing the submitted tasks in FIFO order
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+
+    std::mutex mutex;
+    // Signaled when a task is submitted or the pool is shutting down
+    std::condition_variable taskAvailable;
+    // Signaled when the last pending task has finished
+    std::condition_variable allDone;
+
+    // Number of tasks submitted but not finished yet
+    int pendingCount = 0;
+    bool shuttingDown = false;
+
+    void runWorker();
+
+public:
+    /**
+     * @param threadCount Number of worker threads, 0 = number of hardware threads
+     */
+    ThreadPool(int threadCount);
+
+    /**
+     * @brief Waits for the submitted tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until all the submitted tasks are finished
+     */
+    void wait();
+
+    int getThreadCount() { return workers.size(); }
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TOUR_CONSTRUCTION_HPP
+#define TOUR_CONSTRUCTION_HPP
+
+#include "GraphMatrix.hpp"
+#include "NeighborLists.hpp"
+
+/**
+ * @brief Construction heuristics of the initial path which look only at the candidate edges
+ * (neighbor lists) instead of all the O(n^2) edges, except for rare fallbacks.
+ */
+class TourConstruction
+{
+public:
+    /**
+     * @brief Nearest neighbor tour starting at `first`: the next vertex is the nearest unvisited
+     * candidate of the last one. If all the candidates are visited, the unvisited vertices are scanned.
+     *
+     * @param path Output, graph->getVertexCount() vertices
+     */
+    static void nearestNeighbor(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path);
+
+    /**
+     * @brief Greedy edge matching: the candidate edges are added from the shortest one
+     * as long as no vertex gets a third edge (on directed graphs a second outgoing / incoming edge)
+     * and no cycle is closed (union-find). The resulting fragments are joined by nearest neighbor
+     * from the fragment containing `first`.
+     */
+    static void greedyEdge(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path);
+
+    /**
+     * @brief MST doubling: the minimum spanning tree of the candidate edges (Kruskal, components
+     * left unconnected are chained), walked depth-first from `first`. Visiting the vertices in the
+     * preorder shortcuts the doubled tree, which is at most twice the optimum on metric instances.
+     */
+    static void mstDoubling(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path);
+
+    /**
+     * @brief Orders the vertices along a Hilbert curve over their coordinates
+     *
+     * @return false if the graph has no coordinates
+     */
+    static bool spaceFillingCurve(GraphMatrix *graph, int *path);
+};
+
+#endif
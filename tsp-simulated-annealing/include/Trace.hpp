@@ -0,0 +1,78 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdio>
+#include <climits>
+#include <string>
+
+// Sampling settings of the solver progress trace
+struct TraceParams
+{
+    bool enabled = false;
+    // Sample every N iterations (0 disables iteration based sampling)
+    int everyIters = 0;
+    // Sample every X milliseconds (0 disables time based sampling)
+    int everyMs = 0;
+};
+
+/**
+ * @brief Buffered, sampled log of the solver progress.
+ *
+ * Samples are formatted into an in-memory buffer which is written to the file
+ * only when it grows large or when the trace is closed, so the solver loop never
+ * waits for I/O.
+ */
+class Trace
+{
+private:
+    FILE *file = NULL;
+    std::string buffer;
+
+    int everyIters = 0;
+    unsigned long everyMs = 0;
+
+    // Number of the current run (solve) written to the trace
+    int run = 0;
+
+    // Iteration / elapsed time at which the next sample is due
+    long long nextIteration = LLONG_MAX;
+    unsigned long nextMs = ULONG_MAX;
+
+    void flushBuffer();
+
+public:
+    Trace() {}
+
+    ~Trace();
+
+    /**
+     * @brief Opens (truncates) the trace file and writes the header
+     *
+     * @return false if the file could not be opened
+     */
+    bool open(std::string filePath, TraceParams params);
+
+    void close();
+
+    bool isOpen() { return file != NULL; }
+
+    /**
+     * @brief Marks the beginning of a new solve, resets the sampling schedule
+     */
+    void startRun();
+
+    /**
+     * @brief Returns true when a sample should be written at this point of the solve
+     */
+    bool isDue(long long iteration, unsigned long elapsedMs)
+    {
+        return iteration >= nextIteration || elapsedMs >= nextMs;
+    }
+
+    /**
+     * @brief Writes a sample and schedules the next one
+     */
+    void sample(long long iteration, unsigned long elapsedMs, double temperature, int currentWeight, int bestWeight);
+};
+
+#endif
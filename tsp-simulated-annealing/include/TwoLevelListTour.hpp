@@ -0,0 +1,149 @@
+#ifndef TWO_LEVEL_LIST_TOUR_HPP
+#define TWO_LEVEL_LIST_TOUR_HPP
+
+#include <vector>
+
+/**
+ * @brief Tour stored as a two-level doubly-linked list.
+ *
+ * The tour is cut into about sqrt(n) segments linked in a cyclic list. Every segment holds its
+ * vertices in an array and a reversed bit, so a whole segment is reversed in O(1). Reversing a part
+ * of the tour splits at most two segments at its ends and relinks the segments between them,
+ * which costs O(sqrt(n)) instead of O(n) for the array tour. next(), prev() and between() are O(1).
+ *
+ * Has the same interface as ArrayTour. The shorter complement of a part may be reversed instead of the part,
+ * which traverses the tour in the other direction; a global reversed bit then keeps the orientation if required.
+ */
+class TwoLevelListTour
+{
+private:
+    struct Segment
+    {
+        // Vertices in the raw order; the tour visits them backwards if reversed
+        std::vector<int> vertices;
+        bool reversed;
+        // Neighbor segments in the raw tour order
+        int next;
+        int prev;
+        // Position of the segment in the raw tour order (cyclic)
+        int rank;
+    };
+
+    int size;
+    // Preferred number of vertices of a segment
+    int groupSize;
+    std::vector<Segment> segments;
+    // segmentOf[v] / indexOf[v] = segment of vertex v and its index in the vertex array of the segment
+    std::vector<int> segmentOf;
+    std::vector<int> indexOf;
+    // true if the tour is traversed against the raw order
+    bool reversed = false;
+    // If false, the direction of the traversal may change when a part of the tour is reversed
+    bool keepOrientation;
+
+    // Set when a segment has grown too much, the segments are then rebuilt
+    bool unbalanced = false;
+
+    std::vector<int> buffer;
+    std::vector<int> partBuffer;
+
+    int head(const Segment &segment) { return segment.reversed ? segment.vertices.back() : segment.vertices.front(); }
+    int tail(const Segment &segment) { return segment.reversed ? segment.vertices.front() : segment.vertices.back(); }
+
+    // Index of `vertex` in its segment in the raw tour order
+    int tourIndex(int vertex)
+    {
+        const Segment &segment = segments[segmentOf[vertex]];
+        return segment.reversed ? segment.vertices.size() - 1 - indexOf[vertex] : indexOf[vertex];
+    }
+
+    int rawNext(int vertex)
+    {
+        const Segment &segment = segments[segmentOf[vertex]];
+        const int index = indexOf[vertex];
+        if (segment.reversed)
+        {
+            return index > 0 ? segment.vertices[index - 1] : head(segments[segment.next]);
+        }
+        return index + 1 < (int)segment.vertices.size() ? segment.vertices[index + 1] : head(segments[segment.next]);
+    }
+
+    int rawPrev(int vertex)
+    {
+        const Segment &segment = segments[segmentOf[vertex]];
+        const int index = indexOf[vertex];
+        if (segment.reversed)
+        {
+            return index + 1 < (int)segment.vertices.size() ? segment.vertices[index + 1] : tail(segments[segment.prev]);
+        }
+        return index > 0 ? segment.vertices[index - 1] : tail(segments[segment.prev]);
+    }
+
+    // Returns true if going forward in the raw order from `a` one reaches `b` before (or at) `c`
+    bool rawBetween(int a, int b, int c);
+
+    // Returns the number of vertices of the raw part from `first` to `last`
+    int rawLength(int first, int last);
+
+    // Reverses the raw part from `first` to `last`
+    void rawReverse(int first, int last);
+
+    // Reverses the raw part from `first` to `last` lying inside one segment
+    void reverseInSegment(int first, int last);
+
+    /**
+     * @brief Splits the segment of `vertex` so that `vertex` becomes the head of a segment,
+     * by moving the smaller part into the neighbor segment (never into the segment `keep`)
+     */
+    void split(int vertex, int keep);
+
+    // Replaces the vertices of the segment by `count` `vertices` in the raw tour order
+    void assignSegment(int segmentIndex, const int *vertices, int count);
+
+    // Appends the vertices of the segment in the raw tour order to `out`
+    void appendSegment(int segmentIndex, std::vector<int> &out);
+
+    // Rebuilds the segments from the raw tour order
+    void rebuild();
+
+public:
+    /**
+     * @param keepOrientation true for directed graphs, where the orientation of the tour matters
+     */
+    TwoLevelListTour(int size, bool keepOrientation);
+
+    void set(const int *path);
+
+    void copyTo(int *path);
+
+    int getSize() { return size; }
+
+    int next(int vertex) { return reversed ? rawPrev(vertex) : rawNext(vertex); }
+
+    int prev(int vertex) { return reversed ? rawNext(vertex) : rawPrev(vertex); }
+
+    /**
+     * @brief Returns true if going forward from `a` one reaches `b` before (or at) `c`
+     */
+    bool between(int a, int b, int c) { return reversed ? rawBetween(c, b, a) : rawBetween(a, b, c); }
+
+    /**
+     * @brief Replaces the edges (a, next(a)) and (c, next(c)) by (a, c) and (next(a), next(c)),
+     * reversing the part of the tour from next(a) to c
+     */
+    void twoOptMove(int a, int c);
+
+    /**
+     * @brief Moves the part of the tour from `first` to `last` (going forward) between `after` and next(after),
+     * keeping its orientation. Costs O(n).
+     */
+    void moveSegment(int first, int last, int after);
+
+    /**
+     * @brief Double bridge: for the vertices a, b, c in this order along the tour the parts
+     * [next(a) .. b] and [next(b) .. c] exchange their places, keeping their orientation. Costs O(n).
+     */
+    void doubleBridge(int a, int b, int c);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef TWO_OPT_HPP
+#define TWO_OPT_HPP
+
+#include <vector>
+
+#include "GraphMatrix.hpp"
+#include "TSPAlgorithm.hpp"
+#include "AlgorithmParams.hpp"
+#include "NeighborLists.hpp"
+#include "ArrayTour.hpp"
+#include "TwoLevelListTour.hpp"
+#include "Path.hpp"
+
+/**
+ * @brief 2-opt local search (descent to a local optimum).
+ *
+ * Only new edges to the candidates of the neighbor lists are tried and the first improving move
+ * is applied. Every vertex has a don't-look bit: a vertex is looked at again only after one of
+ * its path edges has changed, so the search does not rescan the whole path after every move.
+ *
+ * On directed graphs only the successor direction is searched and the weight change of the
+ * reversed part is computed by walking it.
+ *
+ * `Tour` is ArrayTour or TwoLevelListTour (instantiated in TwoOpt.cpp).
+ */
+template <class Tour>
+class TwoOpt : public TSPAlgorithm
+{
+private:
+    NeighborLists neighbors;
+    Tour tour;
+
+    // Vertices with the don't-look bit off, waiting to be looked at (FIFO ring buffer)
+    std::vector<int> queue;
+    std::vector<char> queued;
+    int queueHead = 0;
+    int queueCount = 0;
+
+    long moveCount = 0;
+
+    // Turns the don't-look bit of `vertex` off
+    void activate(int vertex);
+
+    /**
+     * @brief Looks for an improving 2-opt move adding an edge from `a` to one of its candidates and applies it
+     *
+     * @return true if a move has been applied
+     */
+    bool improveVertex(int a);
+
+    /**
+     * @brief Returns the weight change of reversing the part of the tour from `first` to `last` (directed graphs)
+     */
+    int reversalDelta(int first, int last);
+
+    /**
+     * @brief Improves the currentPath until no improving move is found or the execution time limit is reached
+     */
+    void optimize();
+
+    Path getResultPath();
+
+public:
+    TwoOpt(GraphMatrix *graph, AlgorithmParams params);
+
+    /**
+     * @brief Solves the Traveling Salesman Problem with 2-opt descent from the initial path
+     */
+    Path solveTSP();
+
+    /**
+     * @brief Improves `path` (e.g. the result of the simulated annealing) to a 2-opt local optimum
+     */
+    Path improvePath(const Path &path);
+};
+
+#endif
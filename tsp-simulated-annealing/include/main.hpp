@@ -3,12 +3,22 @@
 
 CSimpleIniA ini;
 
-int main(void);
+int main(int argc, char **argv);
 
-// Tests on instances from files
-void fileInstanceTest(std::string inputDir, std::string outputDir);
+// Tests on instances from files (multiStart - the iterations of every instance run concurrently),
+// loaded through the instance cache in cacheDir (empty: parsed every time)
+void fileInstanceTest(std::string inputDir, std::string outputDir, std::string cacheDir, bool multiStart);
 
 // Tests on random instances
 void randomInstanceTest(std::string outputDir);
 
+// Compares the tour representations of the local search
+void tourBenchmark(std::string outputDir);
+
+// Compares the instance file loaders and the instance cache on all the files of the input directory
+void loaderBenchmark(std::string inputDir, std::string outputDir, std::string cacheDir);
+
+// Measures the savings of reusing the working memory of the runs
+void contextBenchmark(std::string outputDir);
+
 AlgorithmParams getAlorithmParams();
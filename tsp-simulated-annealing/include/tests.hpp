@@ -25,10 +25,65 @@ namespace Tests
      *
      * @param graph Graph for which to test the algorithm
      * @param iterCount Number of test repetitions
+     * @param instancePath Path of the instance file (saved in the checkpoints)
      * @param instanceName Name of the tested instance
      * @param outputPath Path of the results file for single instance test
      **/
-    void fileInstanceTest(GraphMatrix *graph, int iterCount, std::string instanceName, std::string outputPath, AlgorithmParams params);
+    void fileInstanceTest(GraphMatrix *graph, int iterCount, std::string instancePath, std::string instanceName, std::string outputPath, AlgorithmParams params);
+
+    /**
+     * @brief Continues the instance test saved in the checkpoint: the interrupted simulated annealing
+     * run from its saved state, then the remaining runs. The results are appended to the results file of the test.
+     *
+     * @param checkpointPath Path of the checkpoint file
+     * @return false if the checkpoint or its instance could not be read
+     **/
+    bool resumeInstanceTest(std::string checkpointPath);
+
+    /**
+     * @brief Runs independent, differently seeded simulated annealing instances concurrently, saves results to file.
+     * All the runs are cancelled once one of them reaches the known optimum of the graph.
+     *
+     * @param graph Graph for which to test the algorithm
+     * @param runCount Number of runs
+     * @param threadCount Number of worker threads, 0 = number of hardware threads
+     * @param instanceName Name of the tested instance
+     * @param outputPath Path of the results file
+     **/
+    void multiStartTest(GraphMatrix *graph, int runCount, int threadCount, std::string instanceName, std::string outputPath, AlgorithmParams params);
+
+    /**
+     * @brief Compares the array and the two-level list tour: checks that both agree after the same random
+     * 2-opt moves, then times the moves and next() / between() queries on random tours of every size, saves results to file
+     *
+     * @param sizes Numbers of vertices of the tours
+     * @param moveCount Number of 2-opt moves (and of queries) for every size
+     * @param outputPath Path of the results file
+     **/
+    void tourBenchmark(std::vector<int> sizes, int moveCount, std::string outputPath);
+
+    /**
+     * @brief Compares the memory-mapped loader with the std::ifstream one and with the instance cache: loads every
+     * instance file of the directory `repetitions` times with each, checks that all read the same graph, saves results to file
+     *
+     * @param inputDir Directory of the instance files
+     * @param cacheDir Directory of the instance cache files
+     * @param repetitions Number of loads of every file by each loader
+     * @param outputPath Path of the results file
+     **/
+    void loaderBenchmark(std::string inputDir, std::string cacheDir, int repetitions, std::string outputPath);
+
+    /**
+     * @brief Measures what reusing a SolveContext saves: times the construction and destruction of a simulated
+     * annealing with its own buffers and with a reused context, and the path validity check with the context bitset
+     * and with the former sorted copy of the path, on random graphs of every size. Saves results to file
+     *
+     * @param sizes Numbers of vertices of the graphs
+     * @param repetitions Number of constructions (and of checks) for every size
+     * @param outputPath Path of the results file
+     * @param params Params of the constructed simulated annealing
+     **/
+    void contextBenchmark(std::vector<int> sizes, int repetitions, std::string outputPath, AlgorithmParams params);
 
 };
 
@@ -0,0 +1,117 @@
+#include "ArrayTour.hpp"
+#include <utility>
+
+ArrayTour::ArrayTour(int size, bool keepOrientation)
+{
+    this->size = size;
+    this->keepOrientation = keepOrientation;
+    tour.resize(size);
+    position.resize(size);
+}
+
+void ArrayTour::set(const int *path)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        tour[i] = path[i];
+        position[path[i]] = i;
+    }
+}
+
+void ArrayTour::copyTo(int *path)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        path[i] = tour[i];
+    }
+}
+
+void ArrayTour::twoOptMove(int a, int c)
+{
+    const int from = position[a] + 1 == size ? 0 : position[a] + 1;
+    reverse(from, position[c]);
+}
+
+void ArrayTour::reverse(int from, int to)
+{
+    int length = to - from;
+    length = (length < 0 ? length + size : length) + 1;
+
+    // Reversing the rest of the tour gives the same cycle, only traversed in the other direction
+    if (!keepOrientation && 2 * length > size)
+    {
+        const int restFrom = to + 1 == size ? 0 : to + 1;
+        to = from == 0 ? size - 1 : from - 1;
+        from = restFrom;
+        length = size - length;
+    }
+
+    for (int i = 0; i < length / 2; ++i)
+    {
+        const int u = tour[from];
+        const int v = tour[to];
+        tour[from] = v;
+        position[v] = from;
+        tour[to] = u;
+        position[u] = to;
+
+        from = from + 1 == size ? 0 : from + 1;
+        to = to == 0 ? size - 1 : to - 1;
+    }
+}
+
+void ArrayTour::moveSegment(int first, int last, int after)
+{
+    // ... -> a -> [first .. last] -> b -> ... -> after -> q -> ...
+    //   => ... -> a -> b -> ... -> after -> [first .. last] -> q -> ...
+    buffer.clear();
+    const int b = next(last);
+    for (int vertex = b;; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == after)
+        {
+            break;
+        }
+    }
+    for (int vertex = first;; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == last)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(after); vertex != first; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+    }
+    set(buffer.data());
+}
+
+void ArrayTour::doubleBridge(int a, int b, int c)
+{
+    // a -> [X] -> [Y] -> d  =>  a -> [Y] -> [X] -> d
+    buffer.clear();
+    for (int vertex = next(b);; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == c)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(a);; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == b)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(c); vertex != next(a); vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+    }
+    set(buffer.data());
+}
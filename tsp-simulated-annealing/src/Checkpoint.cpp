@@ -0,0 +1,308 @@
+#include "Checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <unistd.h>
+
+// The file starts with the magic bytes and the format version, the payload ends with its checksum
+static const char CHECKPOINT_MAGIC[8] = {'T', 'S', 'P', 'C', 'K', 'P', 'T', '\0'};
+static const uint32_t CHECKPOINT_VERSION = 2;
+
+// The parameters are stored as they are in memory, so a checkpoint can be resumed only by the same build
+static_assert(std::is_trivially_copyable<AlgorithmParams>::value, "AlgorithmParams are stored as raw bytes");
+
+// FNV-1a hash of `size` bytes
+static uint32_t checksum(const char *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Appends the raw bytes of values to a buffer
+class StateWriter
+{
+public:
+    std::string buffer;
+
+    void bytes(const void *data, size_t size)
+    {
+        buffer.append((const char *)data, size);
+    }
+
+    template <class T>
+    void value(const T &value)
+    {
+        bytes(&value, sizeof(T));
+    }
+
+    void string(const std::string &value)
+    {
+        this->value((uint32_t)value.size());
+        bytes(value.data(), value.size());
+    }
+
+    void path(const std::vector<int> &path)
+    {
+        value((uint32_t)path.size());
+        bytes(path.data(), path.size() * sizeof(int));
+    }
+};
+
+// Reads the values written by StateWriter, every read fails past the end of the buffer
+class StateReader
+{
+private:
+    const std::string &buffer;
+    size_t position = 0;
+
+public:
+    StateReader(const std::string &buffer) : buffer(buffer) {}
+
+    bool bytes(void *data, size_t size)
+    {
+        if (size > buffer.size() - position)
+        {
+            return false;
+        }
+        memcpy(data, buffer.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    template <class T>
+    bool value(T &value)
+    {
+        return bytes(&value, sizeof(T));
+    }
+
+    bool string(std::string &value)
+    {
+        uint32_t size;
+        if (!this->value(size) || size > buffer.size() - position)
+        {
+            return false;
+        }
+        value.assign(buffer.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    bool path(std::vector<int> &path)
+    {
+        uint32_t size;
+        if (!value(size) || size > (buffer.size() - position) / sizeof(int))
+        {
+            return false;
+        }
+        path.resize(size);
+        return bytes(path.data(), size * sizeof(int));
+    }
+};
+
+Checkpoint::~Checkpoint()
+{
+    close();
+}
+
+void Checkpoint::open(std::string filePath, int everyMs)
+{
+    close();
+
+    this->filePath = filePath;
+    this->everyMs = everyMs > 0 ? everyMs : 1;
+    stopping = false;
+    writer = std::thread(&Checkpoint::runWriter, this);
+}
+
+void Checkpoint::close()
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stateAvailable.notify_one();
+    writer.join();
+}
+
+void Checkpoint::runWriter()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        stateAvailable.wait(lock, [this]
+                            { return hasPending || stopping; });
+        if (!hasPending)
+        {
+            return;
+        }
+
+        // The whole states are swapped (the vectors exchange their buffers, nothing is copied),
+        // the solver can fill the next state while this one is written
+        std::swap(pending, writing);
+        hasPending = false;
+        isWriting = true;
+        lock.unlock();
+
+        if (!write(filePath, writing))
+        {
+            printf("Could not write the checkpoint file %s\n", filePath.c_str());
+        }
+
+        lock.lock();
+        isWriting = false;
+        stateWritten.notify_all();
+    }
+}
+
+void Checkpoint::startRun(const CheckpointRun &run)
+{
+    this->run = run;
+    nextMs = everyMs;
+}
+
+void Checkpoint::save(unsigned long elapsedMs, const std::function<void(SolverState &)> &fill)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.run = run;
+        fill(pending);
+        hasPending = true;
+    }
+    stateAvailable.notify_one();
+    nextMs = elapsedMs + everyMs;
+}
+
+void Checkpoint::remove()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stateWritten.wait(lock, [this]
+                          { return !hasPending && !isWriting; });
+    }
+    std::remove(filePath.c_str());
+}
+
+bool Checkpoint::write(std::string filePath, const SolverState &state)
+{
+    StateWriter writer;
+    writer.bytes(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    writer.value(CHECKPOINT_VERSION);
+    writer.value((uint32_t)sizeof(AlgorithmParams));
+
+    writer.string(state.run.instancePath);
+    writer.string(state.run.instanceName);
+    writer.string(state.run.outputPath);
+    writer.value(state.run.run);
+    writer.value(state.run.runCount);
+    writer.value(state.run.params);
+
+    writer.value(state.elapsedMs);
+    writer.value(state.rngState);
+    writer.value(state.iteration);
+    writer.value(state.noImprovementIters);
+    writer.value(state.initialPathWeight);
+    writer.value(state.currentPathWeight);
+    writer.value(state.bestFoundPathWeight);
+    writer.value(state.temperature);
+    writer.value(state.initialTemperature);
+    writer.value(state.lundyMeesBeta);
+    writer.value(state.chainLength);
+    writer.value(state.chainIteration);
+    writer.value(state.chainAccepted);
+    writer.value(state.reheatAfter);
+    writer.value(state.stagnationIters);
+    writer.value(state.reheatCount);
+    writer.path(state.currentPath);
+    writer.path(state.bestFoundPath);
+    writer.value(checksum(writer.buffer.data(), writer.buffer.size()));
+
+    // The previous checkpoint is replaced only by a completely written one
+    const std::string tempPath = filePath + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    const bool written = fwrite(writer.buffer.data(), 1, writer.buffer.size(), file) == writer.buffer.size() &&
+                         fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0 || !written)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return rename(tempPath.c_str(), filePath.c_str()) == 0;
+}
+
+bool Checkpoint::read(std::string filePath, SolverState &state)
+{
+    FILE *file = fopen(filePath.c_str(), "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    std::string buffer;
+    char chunk[1 << 16];
+    size_t size;
+    while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        buffer.append(chunk, size);
+    }
+    fclose(file);
+
+    uint32_t storedChecksum;
+    if (buffer.size() < sizeof(CHECKPOINT_MAGIC) + sizeof(storedChecksum))
+    {
+        return false;
+    }
+    const size_t payloadSize = buffer.size() - sizeof(storedChecksum);
+    memcpy(&storedChecksum, buffer.data() + payloadSize, sizeof(storedChecksum));
+    if (memcmp(buffer.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+        checksum(buffer.data(), payloadSize) != storedChecksum)
+    {
+        return false;
+    }
+    buffer.resize(payloadSize);
+
+    StateReader reader(buffer);
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint32_t version;
+    uint32_t paramsSize;
+    if (!reader.bytes(magic, sizeof(magic)) || !reader.value(version) || !reader.value(paramsSize) ||
+        version != CHECKPOINT_VERSION || paramsSize != sizeof(AlgorithmParams))
+    {
+        return false;
+    }
+
+    return reader.string(state.run.instancePath) &&
+           reader.string(state.run.instanceName) &&
+           reader.string(state.run.outputPath) &&
+           reader.value(state.run.run) &&
+           reader.value(state.run.runCount) &&
+           reader.value(state.run.params) &&
+           reader.value(state.elapsedMs) &&
+           reader.value(state.rngState) &&
+           reader.value(state.iteration) &&
+           reader.value(state.noImprovementIters) &&
+           reader.value(state.initialPathWeight) &&
+           reader.value(state.currentPathWeight) &&
+           reader.value(state.bestFoundPathWeight) &&
+           reader.value(state.temperature) &&
+           reader.value(state.initialTemperature) &&
+           reader.value(state.lundyMeesBeta) &&
+           reader.value(state.chainLength) &&
+           reader.value(state.chainIteration) &&
+           reader.value(state.chainAccepted) &&
+           reader.value(state.reheatAfter) &&
+           reader.value(state.stagnationIters) &&
+           reader.value(state.reheatCount) &&
+           reader.path(state.currentPath) &&
+           reader.path(state.bestFoundPath);
+}
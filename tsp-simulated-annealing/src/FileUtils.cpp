@@ -1,8 +1,502 @@
 #include "FileUtils.hpp"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-GraphMatrix *FileUtils::loadGraph(std::string filePath)
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    const char *data = NULL;
+    size_t size = 0;
+
+    ~MappedFile()
+    {
+        if (data != NULL)
+        {
+            munmap((void *)data, size);
+        }
+    }
+
+    // Returns false if the file could not be opened, an empty file has no mapping
+    bool open(const std::string &filePath)
+    {
+        const int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        bool opened = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+        if (opened && st.st_size > 0)
+        {
+            void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            opened = mapping != MAP_FAILED;
+            if (opened)
+            {
+                data = (const char *)mapping;
+                size = st.st_size;
+                madvise(mapping, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        return opened;
+    }
+};
+
+// Reads the whitespace separated tokens of an instance file, counting the lines for the error messages
+class InstanceParser
+{
+private:
+    const char *position;
+    const char *end;
+    int line = 1;
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    void skipSpaces()
+    {
+        while (position < end && isSpace(*position))
+        {
+            line += *position == '\n';
+            ++position;
+        }
+    }
+
+public:
+    std::string error;
+
+    InstanceParser(const char *data, size_t size) : position(data), end(data + size) {}
+
+    bool readWord(std::string &word)
+    {
+        skipSpaces();
+        const char *start = position;
+        while (position < end && !isSpace(*position))
+        {
+            ++position;
+        }
+        word.assign(start, position);
+        return position != start;
+    }
+
+    // Reads a decimal integer; on failure the position stays at the start of the token
+    bool readInt(int &value)
+    {
+        skipSpaces();
+        const char *start = position;
+        const bool negative = position < end && *position == '-';
+        if (negative || (position < end && *position == '+'))
+        {
+            ++position;
+        }
+        const char *digits = position;
+        long long number = 0;
+        while (position < end && (unsigned)(*position - '0') < 10)
+        {
+            number = number * 10 + (*position - '0');
+            if (number > (long long)INT_MAX + 1)
+            {
+                break;
+            }
+            ++position;
+        }
+        if (position == digits || (position < end && !isSpace(*position)) || (!negative && number > INT_MAX))
+        {
+            position = start;
+            return false;
+        }
+        value = negative ? (int)-number : (int)number;
+        return true;
+    }
+
+    // Reads a decimal floating point number; on failure the position stays at the start of the token
+    bool readDouble(double &value)
+    {
+        skipSpaces();
+        const char *start = position;
+        std::string token;
+        readWord(token);
+        char *tokenEnd;
+        value = strtod(token.c_str(), &tokenEnd);
+        // nan / inf are not coordinates (and pass every range check under -ffast-math)
+        if (token.empty() || *tokenEnd != '\0' || token.find_first_not_of("0123456789.eE+-") != std::string::npos)
+        {
+            position = start;
+            return false;
+        }
+        return true;
+    }
+
+    // Reads the rest of the current line (after the leading whitespace), false at the end of the file
+    bool readLine(std::string &text)
+    {
+        skipSpaces();
+        const char *start = position;
+        while (position < end && *position != '\n')
+        {
+            ++position;
+        }
+        text.assign(start, position);
+        return position != start;
+    }
+
+    bool atEnd()
+    {
+        skipSpaces();
+        return position == end;
+    }
+
+    // Sets the error message, prefixed with the current line
+    bool failWith(const std::string &message)
+    {
+        error = std::to_string(line) + ": " + message;
+        return false;
+    }
+
+    // Sets the error message: what was expected and the token found instead
+    bool fail(const std::string &expected)
+    {
+        skipSpaces();
+        std::string found;
+        const char *start = position;
+        readWord(found);
+        position = start;
+        return failWith("expected " + expected + ", found " +
+                        (found.empty() ? std::string("the end of the file") : "'" + found.substr(0, 20) + "'"));
+    }
+};
+
+// Sets `error` (if requested) to the message prefixed with the file path
+static void setError(std::string *error, const std::string &filePath, const std::string &message)
+{
+    if (error != NULL)
+    {
+        *error = filePath + ":" + message;
+    }
+}
+
+// The TSPLIB EDGE_WEIGHT_TYPEs computed from the node coordinates
+enum CoordinateType
+{
+    Euc2d,
+    Ceil2d,
+    Att,
+    Geo,
+};
+
+static const char *coordinateTypeNames[] = {"EUC_2D", "CEIL_2D", "ATT", "GEO"};
+
+// TSPLIB's values, the published GEO optima depend on them
+static const double GEO_PI = 3.141592;
+static const double GEO_RADIUS = 6378.388;
+
+// TSPLIB GEO coordinate (DDD.MM, degrees and minutes) in radians
+static double geoRadians(double value)
+{
+    const double degrees = (int)value;
+    return GEO_PI * (degrees + 5.0 * (value - degrees) / 3.0) / 180.0;
+}
+
+// TSPLIB distance between the vertices u and v, GEO coordinates in radians
+static int coordinateWeight(CoordinateType type, const std::vector<double> &x, const std::vector<double> &y, int u, int v)
+{
+    const double dx = x[u] - x[v];
+    const double dy = y[u] - y[v];
+    if (type == Ceil2d)
+    {
+        return (int)std::ceil(std::sqrt(dx * dx + dy * dy));
+    }
+    if (type == Att)
+    {
+        const double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+        const int t = (int)(r + 0.5);
+        return t < r ? t + 1 : t;
+    }
+    if (type == Geo)
+    {
+        const double q1 = std::cos(dy);
+        const double q2 = std::cos(dx);
+        const double q3 = std::cos(x[u] + x[v]);
+        const double c = 0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3);
+        return (int)(GEO_RADIUS * std::acos(c < 1.0 ? c : 1.0) + 1.0);
+    }
+    return (int)(std::sqrt(dx * dx + dy * dy) + 0.5);
+}
+
+/**
+ * @brief Reads a TSPLIB instance with node coordinates ("KEY : value" header, NODE_COORD_SECTION),
+ * the weights are computed from the coordinates and the coordinates kept in the graph. An OPTIMUM entry gives the optimum.
+ */
+static GraphMatrix *loadTsplibGraph(InstanceParser &parser, size_t fileSize)
+{
+    std::string name;
+    int verticesNum = 0;
+    int type = -1;
+    int optimum = 0;
+    bool optimumIsKnown = false;
+
+    std::string line;
+    while (parser.error.empty())
+    {
+        if (!parser.readLine(line))
+        {
+            parser.failWith("expected NODE_COORD_SECTION, found the end of the file");
+            break;
+        }
+        const size_t colon = line.find(':');
+        std::string key = line.substr(0, colon);
+        std::string value = colon == std::string::npos ? "" : line.substr(colon + 1);
+        key.erase(key.find_last_not_of(" \t\r") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+
+        if (key == "NODE_COORD_SECTION")
+        {
+            if (type < 0)
+            {
+                parser.failWith("expected EDGE_WEIGHT_TYPE before NODE_COORD_SECTION");
+            }
+            break;
+        }
+        if (key == "NAME")
+        {
+            name = value;
+        }
+        else if (key == "TYPE")
+        {
+            if (value != "TSP")
+            {
+                parser.failWith("unsupported TYPE '" + value.substr(0, 20) + "', expected TSP");
+            }
+        }
+        else if (key == "DIMENSION")
+        {
+            char *valueEnd;
+            const long dimension = strtol(value.c_str(), &valueEnd, 10);
+            if (value.empty() || *valueEnd != '\0' || dimension <= 0 || dimension > INT_MAX)
+            {
+                parser.failWith("expected the number of vertices, found '" + value.substr(0, 20) + "'");
+            }
+            // Every node line takes at least six characters
+            else if ((size_t)dimension * 6 > fileSize)
+            {
+                parser.failWith(value + " vertices do not fit in a file of " + std::to_string(fileSize) + " bytes");
+            }
+            verticesNum = dimension;
+        }
+        else if (key == "EDGE_WEIGHT_TYPE")
+        {
+            type = 0;
+            while (type <= Geo && value != coordinateTypeNames[type])
+            {
+                ++type;
+            }
+            if (type > Geo)
+            {
+                parser.failWith("unsupported EDGE_WEIGHT_TYPE '" + value.substr(0, 20) + "', expected EUC_2D, CEIL_2D, ATT or GEO");
+            }
+        }
+        else if (key == "OPTIMUM")
+        {
+            char *valueEnd;
+            const long number = strtol(value.c_str(), &valueEnd, 10);
+            optimumIsKnown = !value.empty() && *valueEnd == '\0' && number >= 0 && number <= INT_MAX;
+            if (!optimumIsKnown)
+            {
+                parser.failWith("expected the optimum, found '" + value.substr(0, 20) + "'");
+            }
+            optimum = number;
+        }
+        else if (colon == std::string::npos)
+        {
+            parser.failWith("unsupported section '" + key.substr(0, 20) + "'");
+        }
+    }
+    if (parser.error.empty() && verticesNum <= 0)
+    {
+        parser.failWith("expected DIMENSION before NODE_COORD_SECTION");
+    }
+    if (!parser.error.empty())
+    {
+        return NULL;
+    }
+
+    // The coordinates are kept as written (GEO: DDD.MM), the weights use the GEO ones in radians
+    GraphMatrix *graph = new GraphMatrix(verticesNum);
+    graph->x.resize(verticesNum);
+    graph->y.resize(verticesNum);
+    std::vector<char> seen(verticesNum, false);
+    for (int k = 0; k < verticesNum && parser.error.empty(); ++k)
+    {
+        int id;
+        double x;
+        double y;
+        if (!parser.readInt(id) || id < 1 || id > verticesNum)
+        {
+            parser.fail("a node id from 1 to " + std::to_string(verticesNum));
+        }
+        else if (seen[id - 1])
+        {
+            parser.failWith("duplicate node " + std::to_string(id));
+        }
+        else if (!parser.readDouble(x) || !parser.readDouble(y))
+        {
+            parser.fail("the coordinates of node " + std::to_string(id));
+        }
+        else
+        {
+            seen[id - 1] = true;
+            graph->x[id - 1] = x;
+            graph->y[id - 1] = y;
+        }
+    }
+    if (parser.error.empty() && !parser.atEnd())
+    {
+        std::string word;
+        parser.readWord(word);
+        if (word != "EOF" || !parser.atEnd())
+        {
+            parser.failWith("expected the end of the file after " + std::to_string(verticesNum) + " nodes");
+        }
+    }
+    if (!parser.error.empty())
+    {
+        delete graph;
+        return NULL;
+    }
+
+    std::vector<double> x = graph->x;
+    std::vector<double> y = graph->y;
+    if (type == Geo)
+    {
+        std::transform(x.begin(), x.end(), x.begin(), geoRadians);
+        std::transform(y.begin(), y.end(), y.begin(), geoRadians);
+    }
+    for (int u = 0; u < verticesNum; ++u)
+    {
+        graph->addEdge(u, u, 0);
+        for (int v = u + 1; v < verticesNum; ++v)
+        {
+            const int weight = coordinateWeight((CoordinateType)type, x, y, u, v);
+            graph->addEdge(u, v, weight);
+            graph->addEdge(v, u, weight);
+        }
+    }
+
+    if (optimumIsKnown)
+    {
+        graph->setOptimum(optimum);
+    }
+    graph->name = name;
+    graph->directed = false;
+    return graph;
+}
+
+GraphMatrix *FileUtils::loadGraph(std::string filePath, std::string *error)
+{
+    MappedFile file;
+    if (!file.open(filePath))
+    {
+        setError(error, filePath, " cannot open the file");
+        return NULL;
+    }
+
+    InstanceParser parser(file.data, file.size);
+
+    // A TSPLIB file is recognized by the "KEY : value" header
+    const char *lineEnd = (const char *)memchr(file.data, '\n', file.size);
+    if (memchr(file.data, ':', (lineEnd != NULL ? lineEnd : file.data + file.size) - file.data) != NULL)
+    {
+        GraphMatrix *graph = loadTsplibGraph(parser, file.size);
+        if (graph == NULL)
+        {
+            setError(error, filePath, parser.error);
+        }
+        return graph;
+    }
+
+    std::string name;
+    int verticesNum;
+    if (!parser.readWord(name))
+    {
+        parser.fail("the instance name");
+    }
+    else if (!parser.readInt(verticesNum) || verticesNum <= 0)
+    {
+        parser.fail("the number of vertices");
+    }
+    // Every weight takes at least two characters, a larger number of vertices would allocate a matrix for nothing
+    else if ((size_t)verticesNum * verticesNum > file.size / 2)
+    {
+        parser.failWith(std::to_string(verticesNum) + " vertices do not fit in a file of " +
+                        std::to_string(file.size) + " bytes");
+    }
+    if (!parser.error.empty())
+    {
+        setError(error, filePath, parser.error);
+        return NULL;
+    }
+
+    // The weights are stored straight into the rows of the matrix
+    GraphMatrix *graph = new GraphMatrix(verticesNum);
+    int optimum = 0;
+    bool optimumIsKnown = false;
+    for (int i = 0; i < verticesNum && parser.error.empty(); i++)
+    {
+        for (int j = 0; j < verticesNum; j++)
+        {
+            int weight;
+            if (!parser.readInt(weight))
+            {
+                parser.fail("the weight of (" + std::to_string(i) + ", " + std::to_string(j) + ")");
+                break;
+            }
+            graph->addEdge(i, j, weight);
+        }
+    }
+    // The optimum is optional
+    if (parser.error.empty() && !parser.atEnd())
+    {
+        optimumIsKnown = parser.readInt(optimum);
+        if (!optimumIsKnown)
+        {
+            parser.fail("the optimum");
+        }
+    }
+    if (parser.error.empty() && !parser.atEnd())
+    {
+        parser.fail("the end of the file after " + std::to_string(verticesNum) + " x " +
+                    std::to_string(verticesNum) + " weights and the optimum");
+    }
+    if (!parser.error.empty())
+    {
+        setError(error, filePath, parser.error);
+        delete graph;
+        return NULL;
+    }
+
+    if (optimumIsKnown)
+    {
+        graph->setOptimum(optimum);
+    }
+    graph->name = name;
+    graph->directed = !graph->isSymmetric();
+    return graph;
+}
+
+GraphMatrix *FileUtils::loadGraphWithStreams(std::string filePath)
 {
     std::ifstream fin(filePath);
 
@@ -31,6 +525,7 @@ GraphMatrix *FileUtils::loadGraph(std::string filePath)
     int optimum;
     fin >> optimum;
     graph->setOptimum(optimum);
+    graph->directed = !graph->isSymmetric();
 
     fin.close();
     return graph;
@@ -74,6 +569,23 @@ void FileUtils::appendTestResult(std::string filePath, TestResult testResult)
     ofs.close();
 }
 
+void FileUtils::appendCancelledTestResult(std::string filePath, std::string instanceName, int vertexCount)
+{
+    std::ofstream ofs;
+
+    ofs.open(filePath, std::ios_base::app);
+
+    if (!ofs)
+        return;
+
+    ofs << instanceName
+        << ", "
+        << vertexCount
+        << ", , cancelled, , \n";
+
+    ofs.close();
+}
+
 void FileUtils::appendRandomInstanceTestResult(std::string filePath, int vertexCount, unsigned long elapsedTime)
 {
     std::ofstream ofs;
@@ -102,6 +614,102 @@ void FileUtils::writeRandomInstanceTestHeader(std::string filePath)
     fout.close();
 }
 
+void FileUtils::writeLoaderBenchmarkHeader(std::string filePath)
+{
+    std::ofstream fout(filePath);
+
+    if (!fout)
+        return;
+
+    fout << "instance, number of vertices, file size [B], stream load [ns], mmap load [ns], speedup, cache load [ns]\n";
+    fout.close();
+}
+
+void FileUtils::appendLoaderBenchmarkResult(std::string filePath, std::string instanceName, int vertexCount, long fileSize, unsigned long streamTimeNs, unsigned long mmapTimeNs, unsigned long cacheTimeNs)
+{
+    std::ofstream ofs;
+
+    ofs.open(filePath, std::ios_base::app);
+
+    if (!ofs)
+        return;
+
+    ofs << instanceName << ", "
+        << vertexCount << ", "
+        << fileSize << ", "
+        << streamTimeNs << ", "
+        << mmapTimeNs << ", "
+        << (double)streamTimeNs / mmapTimeNs << ", "
+        << cacheTimeNs
+        << "\n";
+
+    ofs.close();
+}
+
+void FileUtils::writeTourBenchmarkHeader(std::string filePath)
+{
+    std::ofstream fout(filePath);
+
+    if (!fout)
+        return;
+
+    fout << "tour, number of vertices, moves, move time [ns], ns per move, queries, ns per query\n";
+    fout.close();
+}
+
+void FileUtils::appendTourBenchmarkResult(std::string filePath, std::string tourName, int vertexCount, int moveCount, unsigned long moveTimeNs, int queryCount, unsigned long queryTimeNs)
+{
+    std::ofstream ofs;
+
+    ofs.open(filePath, std::ios_base::app);
+
+    if (!ofs)
+        return;
+
+    ofs << tourName << ", "
+        << vertexCount << ", "
+        << moveCount << ", "
+        << moveTimeNs << ", "
+        << (double)moveTimeNs / moveCount << ", "
+        << queryCount << ", "
+        << (double)queryTimeNs / queryCount
+        << "\n";
+
+    ofs.close();
+}
+
+void FileUtils::writeContextBenchmarkHeader(std::string filePath)
+{
+    std::ofstream fout(filePath);
+
+    if (!fout)
+        return;
+
+    fout << "number of vertices, repetitions, ns per construction (own buffers), ns per construction (reused context), "
+            "ns per check (sorted copy), ns per check (bitset)\n";
+    fout.close();
+}
+
+void FileUtils::appendContextBenchmarkResult(std::string filePath, int vertexCount, int repetitions, unsigned long ownedTimeNs, unsigned long reusedTimeNs, unsigned long sortedCheckTimeNs, unsigned long bitsetCheckTimeNs)
+{
+    std::ofstream ofs;
+
+    ofs.open(filePath, std::ios_base::app);
+
+    if (!ofs)
+        return;
+
+    ofs << vertexCount << ", "
+        << repetitions << ", "
+        << (double)ownedTimeNs / repetitions << ", "
+        << (double)reusedTimeNs / repetitions << ", "
+        << (double)sortedCheckTimeNs / repetitions << ", "
+        << (double)bitsetCheckTimeNs / repetitions
+        << "\n";
+
+    ofs.close();
+}
+
 std::string FileUtils::pathToStr(std::vector<int> path)
 {
     std::string res;
@@ -1,16 +1,42 @@
 #include "GraphMatrix.hpp"
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+// Rows start at multiples of the cache line size, so vector loads of a row do not split cache lines
+static const int ROW_ALIGNMENT = 64;
 
 GraphMatrix::GraphMatrix(int size)
 {
     this->size = size;
-    matrix = new int *[size];
+    stride = getStrideFor(size);
 
-    for (int i = 0; i < size; ++i)
+    void *memory = NULL;
+    if (posix_memalign(&memory, ROW_ALIGNMENT, std::max((size_t)1, (size_t)size * stride) * sizeof(int)) != 0)
     {
-        matrix[i] = new int[size];
+        throw std::bad_alloc();
     }
+    weights = (int *)memory;
+    // The padding at the end of the rows is never read as a weight
+    std::fill(weights, weights + (size_t)size * stride, 0);
+}
+
+GraphMatrix::GraphMatrix(int size, int *weights, void *mapping, size_t mappingSize)
+{
+    this->size = size;
+    this->weights = weights;
+    this->mapping = mapping;
+    this->mappingSize = mappingSize;
+    stride = getStrideFor(size);
+}
+
+int GraphMatrix::getStrideFor(int size)
+{
+    const int rowAlignment = ROW_ALIGNMENT / sizeof(int);
+    return (size + rowAlignment - 1) / rowAlignment * rowAlignment;
 }
 
 void GraphMatrix::display()
@@ -31,7 +57,7 @@ void GraphMatrix::display()
         printf("%2i |", i);
         for (int j = 0; j < size; ++j)
         {
-            printf(" %3i ", matrix[i][j]);
+            printf(" %3i ", getWeight(i, j));
         }
         printf("\n");
     }
@@ -42,11 +68,6 @@ void GraphMatrix::display()
     printf("Directed: %s", directed ? "true" : "false");
 }
 
-void GraphMatrix::addEdge(int u, int v, int weight)
-{
-    matrix[u][v] = weight;
-}
-
 int GraphMatrix::getVertexCount()
 {
     return this->size;
@@ -58,7 +79,7 @@ std::vector<int> GraphMatrix::getAdj(int v)
 
     for (int i = 0; i < this->size; ++i)
     {
-        if (matrix[v][i] != 0)
+        if (getWeight(v, i) != 0)
         {
             adj.push_back(i);
         }
@@ -66,18 +87,31 @@ std::vector<int> GraphMatrix::getAdj(int v)
     return adj;
 }
 
-int GraphMatrix::getWeight(int u, int v)
+bool GraphMatrix::isSymmetric()
 {
-    return matrix[u][v];
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = i + 1; j < size; ++j)
+        {
+            if (getWeight(i, j) != getWeight(j, i))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 GraphMatrix::~GraphMatrix()
 {
-    for (int i = 0; i < size; ++i)
+    if (mapping != NULL)
+    {
+        munmap(mapping, mappingSize);
+    }
+    else
     {
-        delete[] matrix[i];
+        free(weights);
     }
-    delete[] matrix;
 }
 
 void GraphMatrix::setOptimum(int optimum)
@@ -0,0 +1,232 @@
+#include "InstanceCache.hpp"
+#include "FileUtils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char CACHE_MAGIC[8] = {'T', 'S', 'P', 'I', 'N', 'S', 'T', '\0'};
+static const uint32_t CACHE_VERSION = 2;
+
+// Weight types of the cache files, the instance files define only integer weights
+static const uint32_t WEIGHT_TYPE_INT32 = 1;
+
+// Everything stored as it is in memory, so a cache file is read only by a build of the same byte order
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    // Instance name, truncated to 47 characters
+    char name[48];
+    int32_t vertexCount;
+    int32_t stride;
+    uint32_t weightType;
+    uint32_t symmetric;
+    uint32_t optimumIsKnown;
+    int32_t optimum;
+    // Size and modification time of the instance file the cache was written from
+    uint64_t sourceSize;
+    int64_t sourceModifiedNs;
+    uint64_t weightsSize;
+    uint32_t weightsChecksum;
+    // The x and then the y coordinates of the vertices (doubles) follow the matrix if set
+    uint32_t hasCoordinates;
+    uint32_t coordinatesChecksum;
+    // Checksum of the header bytes before it
+    uint32_t headerChecksum;
+};
+
+// The matrix follows the header, so its rows keep the alignment of the (page aligned) mapping
+static_assert(sizeof(CacheHeader) == 128, "The header size is a multiple of the row alignment");
+
+// FNV-1a hash of `size` bytes
+static uint32_t checksum(const char *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Size and modification time of the instance file, false if it cannot be read
+static bool sourceVersion(const std::string &instancePath, uint64_t &size, int64_t &modifiedNs)
+{
+    struct stat st;
+    if (stat(instancePath.c_str(), &st) != 0)
+    {
+        return false;
+    }
+    size = st.st_size;
+    modifiedNs = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+std::string InstanceCache::cachePath(std::string instancePath, std::string cacheDir)
+{
+    const size_t slash = instancePath.find_last_of('/');
+    const std::string fileName = slash == std::string::npos ? instancePath : instancePath.substr(slash + 1);
+    // The hash of the absolute path tells apart the instance files of the same name in different directories
+    char *absolutePath = realpath(instancePath.c_str(), NULL);
+    const std::string sourcePath = absolutePath != NULL ? absolutePath : instancePath;
+    free(absolutePath);
+    char pathHash[16];
+    snprintf(pathHash, sizeof(pathHash), "%08x", checksum(sourcePath.data(), sourcePath.size()));
+    return cacheDir + "/" + fileName + "." + pathHash + ".bin";
+}
+
+GraphMatrix *InstanceCache::load(std::string instancePath, std::string cacheDir, std::string *error)
+{
+    if (cacheDir.empty())
+    {
+        return FileUtils::loadGraph(instancePath, error);
+    }
+
+    const std::string path = cachePath(instancePath, cacheDir);
+    GraphMatrix *graph = read(path, instancePath);
+    if (graph != NULL)
+    {
+        return graph;
+    }
+
+    graph = FileUtils::loadGraph(instancePath, error);
+    if (graph == NULL)
+    {
+        return NULL;
+    }
+    mkdir(cacheDir.c_str(), 0755);
+    if (!write(path, instancePath, graph))
+    {
+        printf("Could not write the instance cache file %s\n", path.c_str());
+    }
+    return graph;
+}
+
+bool InstanceCache::write(std::string cachePath, std::string instancePath, GraphMatrix *graph)
+{
+    const int vertexCount = graph->getVertexCount();
+    const size_t weightsSize = (size_t)vertexCount * graph->getStride() * sizeof(int);
+    const char *weights = (const char *)graph->getWeights();
+    // The x coordinates followed by the y coordinates, empty if the graph has none
+    std::vector<double> coordinates(graph->x);
+    coordinates.insert(coordinates.end(), graph->y.begin(), graph->y.end());
+    const size_t coordinatesSize = coordinates.size() * sizeof(double);
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    strncpy(header.name, graph->name.c_str(), sizeof(header.name) - 1);
+    header.vertexCount = vertexCount;
+    header.stride = graph->getStride();
+    header.weightType = WEIGHT_TYPE_INT32;
+    header.symmetric = !graph->directed;
+    header.optimumIsKnown = graph->isOptimumKnown();
+    header.optimum = graph->getOptimum();
+    if (!sourceVersion(instancePath, header.sourceSize, header.sourceModifiedNs))
+    {
+        return false;
+    }
+    header.weightsSize = weightsSize;
+    header.weightsChecksum = checksum(weights, weightsSize);
+    header.hasCoordinates = graph->hasCoordinates();
+    header.coordinatesChecksum = checksum((const char *)coordinates.data(), coordinatesSize);
+    header.headerChecksum = checksum((const char *)&header, offsetof(CacheHeader, headerChecksum));
+
+    // Processes writing the same cache file concurrently use different temporary files,
+    // a reader finds either no cache file or a complete one
+    const std::string tempPath = cachePath + ".tmp" + std::to_string(getpid());
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         fwrite(weights, 1, weightsSize, file) == weightsSize &&
+                         fwrite(coordinates.data(), 1, coordinatesSize, file) == coordinatesSize;
+    if (fclose(file) != 0 || !written)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return rename(tempPath.c_str(), cachePath.c_str()) == 0;
+}
+
+GraphMatrix *InstanceCache::read(std::string cachePath, std::string instancePath, bool verifyWeights)
+{
+    uint64_t sourceSize;
+    int64_t sourceModifiedNs;
+    if (!sourceVersion(instancePath, sourceSize, sourceModifiedNs))
+    {
+        return NULL;
+    }
+
+    const int fd = open(cachePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(CacheHeader))
+    {
+        // A private writable mapping: the pages are shared with the page cache (and the other processes)
+        // until the graph is modified, a modification never reaches the file
+        mapping = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    const size_t fileSize = st.st_size;
+    const CacheHeader &header = *(const CacheHeader *)mapping;
+    const char *weights = (const char *)mapping + sizeof(CacheHeader);
+    // Checked against the file size before the coordinates are read
+    const size_t coordinatesSize = fileSize >= sizeof(CacheHeader) + header.weightsSize && header.hasCoordinates
+                                       ? 2 * (size_t)header.vertexCount * sizeof(double)
+                                       : 0;
+    const char *coordinates = weights + header.weightsSize;
+    const bool valid =
+        memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+        header.version == CACHE_VERSION && header.headerSize == sizeof(CacheHeader) &&
+        header.headerChecksum == checksum((const char *)&header, offsetof(CacheHeader, headerChecksum)) &&
+        header.weightType == WEIGHT_TYPE_INT32 && header.vertexCount > 0 &&
+        header.stride == GraphMatrix::getStrideFor(header.vertexCount) &&
+        header.weightsSize == (uint64_t)header.vertexCount * header.stride * sizeof(int) &&
+        fileSize == sizeof(CacheHeader) + header.weightsSize + coordinatesSize &&
+        header.sourceSize == sourceSize && header.sourceModifiedNs == sourceModifiedNs &&
+        (!verifyWeights || header.weightsChecksum == checksum(weights, header.weightsSize)) &&
+        (coordinatesSize == 0 || header.coordinatesChecksum == checksum(coordinates, coordinatesSize));
+    if (!valid)
+    {
+        munmap(mapping, fileSize);
+        return NULL;
+    }
+
+    GraphMatrix *graph = new GraphMatrix(header.vertexCount, (int *)weights, mapping, fileSize);
+    graph->name.assign(header.name, strnlen(header.name, sizeof(header.name)));
+    if (header.optimumIsKnown)
+    {
+        graph->setOptimum(header.optimum);
+    }
+    graph->directed = !header.symmetric;
+    if (coordinatesSize > 0)
+    {
+        // Copied, the coordinates are few and read only by the construction of the initial path
+        const double *x = (const double *)coordinates;
+        graph->x.assign(x, x + header.vertexCount);
+        graph->y.assign(x + header.vertexCount, x + 2 * header.vertexCount);
+    }
+    return graph;
+}
@@ -0,0 +1,380 @@
+#include "LinKernighan.hpp"
+#include <algorithm>
+
+// Maximum length of the parts exchanged by the double bridge kick, keeps the kicks local
+static const int KICK_SEGMENT_LENGTH = 50;
+
+template <class Tour>
+LinKernighan<Tour>::LinKernighan(GraphMatrix *graph, AlgorithmParams params)
+    : TSPAlgorithm(graph),
+      neighbors(graph, params.localSearch.neighborCount),
+      tour(graph->getVertexCount(), graph->directed)
+{
+    this->maxNoImprovementIters = INT_MAX;
+    this->maxExecutionTime = params.maxExecutionTimeMs;
+    this->initialPathMode = params.initialPathMode;
+    this->constructionNeighbors = &neighbors;
+    this->maxDepth = params.localSearch.lkMaxDepth;
+    this->breadth = params.localSearch.lkBreadth;
+
+    queue.resize(graphSize);
+    queued.resize(graphSize);
+    usedStamp.resize(graphSize);
+}
+
+template <class Tour>
+Path LinKernighan<Tour>::solveTSP()
+{
+    setInitialPath();
+    currentPathWeight = getCurrentPathWeight();
+    initialPathWeight = currentPathWeight;
+    bestFoundPathWeight = currentPathWeight;
+    printImprovement(0, currentPathWeight);
+
+    iteration = 0;
+    kickCount = 0;
+    noImprovementIters = 0;
+    timeLimitReached = false;
+    startTimer();
+
+    tour.set(currentPath);
+    queueHead = 0;
+    queueCount = 0;
+    for (int i = 0; i < graphSize; ++i)
+    {
+        queued[i] = false;
+    }
+    for (int i = 0; i < graphSize; ++i)
+    {
+        activate(currentPath[i]);
+    }
+    timeLimitReached = !descend();
+
+    tour.copyTo(bestFoundPath);
+    bestFoundPathWeight = currentPathWeight;
+    if (sharedBest == NULL || sharedBest->offer(bestFoundPath, graphSize, bestFoundPathWeight))
+    {
+        printImprovement(0, bestFoundPathWeight);
+    }
+
+    // Smaller tours have no room for a double bridge
+    while (graphSize >= 8 && !timeLimitReached && !endCriterionIsMet())
+    {
+        kick();
+        timeLimitReached = !descend();
+        ++iteration;
+        ++noImprovementIters;
+
+        if (currentPathWeight < bestFoundPathWeight)
+        {
+            tour.copyTo(bestFoundPath);
+            bestFoundPathWeight = currentPathWeight;
+            if (sharedBest == NULL || sharedBest->offer(bestFoundPath, graphSize, bestFoundPathWeight))
+            {
+                printImprovement(iteration, bestFoundPathWeight);
+            }
+            noImprovementIters = 0;
+        }
+        else if (currentPathWeight > bestFoundPathWeight)
+        {
+            tour.set(bestFoundPath);
+            currentPathWeight = bestFoundPathWeight;
+        }
+    }
+    if (timeLimitReached)
+    {
+        printf("The execution time limit has been reached\n");
+    }
+    printf("Kicks: %li, time: %lu ms\n", kickCount, timer.getElapsedMs());
+    printPath(bestFoundPath);
+
+    std::vector<int> resPath(bestFoundPath, bestFoundPath + graphSize);
+    return Path(resPath, bestFoundPathWeight, getPrd(bestFoundPathWeight));
+}
+
+template <class Tour>
+bool LinKernighan<Tour>::descend()
+{
+    // Every move needs at least 5 vertices
+    if (graphSize < 5)
+    {
+        return true;
+    }
+
+    while (queueCount > 0)
+    {
+        const int vertex = queue[queueHead];
+        queueHead = queueHead + 1 == graphSize ? 0 : queueHead + 1;
+        --queueCount;
+        queued[vertex] = false;
+
+        if (graph->directed)
+        {
+            while (improveOrOpt(vertex))
+            {
+            }
+        }
+        else
+        {
+            forward = true;
+            while (improveLK(vertex))
+            {
+            }
+            forward = false;
+            while (improveLK(vertex))
+            {
+            }
+        }
+
+        if (--itersUntilTimeCheck <= 0 && executionTimeLimit())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Tour>
+void LinKernighan<Tour>::activate(int vertex)
+{
+    if (queued[vertex])
+    {
+        return;
+    }
+    queued[vertex] = true;
+    int tail = queueHead + queueCount;
+    queue[tail >= graphSize ? tail - graphSize : tail] = vertex;
+    ++queueCount;
+}
+
+template <class Tour>
+void LinKernighan<Tour>::flip(int t1, int t2, int t3, int t4)
+{
+    if (forward)
+    {
+        tour.twoOptMove(t1, t4);
+    }
+    else
+    {
+        tour.twoOptMove(t3, t2);
+    }
+    // The array tour may have reversed the other part of the tour
+    forward = tour.next(t1) == t4;
+}
+
+template <class Tour>
+bool LinKernighan<Tour>::improveLK(int t1)
+{
+    const int t2 = succ(t1);
+    const int removed = graph->getWeight(t1, t2);
+    const int *candidates = neighbors.get(t2);
+    const int candidateCount = neighbors.getCount();
+
+    int tried = 0;
+    for (int i = 0; i < candidateCount && tried < breadth; ++i)
+    {
+        const int t3 = candidates[i];
+        const int gain = removed - graph->getWeight(t2, t3);
+        if (gain <= 0)
+        {
+            break;
+        }
+        if (t3 == t1 || t3 == succ(t2))
+        {
+            continue;
+        }
+        ++tried;
+
+        ++stamp;
+        steps.clear();
+        usedStamp[t3] = stamp;
+
+        const int t4 = pred(t3);
+        flip(t1, t2, t3, t4);
+        steps.push_back(t3);
+
+        const int chainGain = gain + graph->getWeight(t4, t3);
+        int bestGain = chainGain - graph->getWeight(t4, t1);
+        int bestStep = 1;
+        if (bestGain <= 0)
+        {
+            bestGain = 0;
+            bestStep = 0;
+        }
+        extendLK(t1, t4, chainGain, bestGain, bestStep);
+
+        if (bestGain > 0)
+        {
+            undoSteps(t1, bestStep);
+            currentPathWeight -= bestGain;
+
+            activate(t1);
+            activate(t2);
+            for (int step = 0; step < bestStep; ++step)
+            {
+                activate(steps[step]);
+                activate(tour.next(steps[step]));
+                activate(tour.prev(steps[step]));
+            }
+            return true;
+        }
+        undoSteps(t1, 0);
+    }
+    return false;
+}
+
+template <class Tour>
+void LinKernighan<Tour>::extendLK(int t1, int t2, int gain, int &bestGain, int &bestStep)
+{
+    const int candidateCount = neighbors.getCount();
+
+    while ((int)steps.size() < maxDepth)
+    {
+        // The next step adds (t2, t3) and removes (t4, t3), the best one maximizes w(t4, t3) - w(t2, t3)
+        const int *candidates = neighbors.get(t2);
+        const int t2Succ = succ(t2);
+        int bestT3 = -1;
+        int bestValue = INT_MIN;
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            const int t3 = candidates[i];
+            const int added = graph->getWeight(t2, t3);
+            if (gain - added <= 0)
+            {
+                break;
+            }
+            if (t3 == t1 || t3 == t2Succ || usedStamp[t3] == stamp)
+            {
+                continue;
+            }
+            const int value = graph->getWeight(pred(t3), t3) - added;
+            if (value > bestValue)
+            {
+                bestValue = value;
+                bestT3 = t3;
+            }
+        }
+        if (bestT3 < 0)
+        {
+            return;
+        }
+
+        const int t3 = bestT3;
+        const int t4 = pred(t3);
+        usedStamp[t3] = stamp;
+        flip(t1, t2, t3, t4);
+        steps.push_back(t3);
+        gain += bestValue;
+
+        const int closedGain = gain - graph->getWeight(t4, t1);
+        if (closedGain > bestGain)
+        {
+            bestGain = closedGain;
+            bestStep = steps.size();
+        }
+        t2 = t4;
+    }
+}
+
+template <class Tour>
+void LinKernighan<Tour>::undoSteps(int t1, int stepCount)
+{
+    while ((int)steps.size() > stepCount)
+    {
+        // The step replaced (t1, t2), (t4, t3) by (t1, t4), (t2, t3): flipping at t3 again restores it
+        const int t3 = steps.back();
+        steps.pop_back();
+        flip(t1, succ(t1), t3, pred(t3));
+    }
+}
+
+template <class Tour>
+bool LinKernighan<Tour>::improveOrOpt(int first)
+{
+    const int candidateCount = neighbors.getCount();
+    const int maxLength = std::min(3, graphSize - 3);
+
+    int last = first;
+    for (int length = 1; length <= maxLength; ++length, last = tour.next(last))
+    {
+        // ... -> a -> [first .. last] -> b -> ... -> p -> q -> ...
+        //   => ... -> a -> b -> ... -> p -> [first .. last] -> q -> ...
+        const int a = tour.prev(first);
+        const int b = tour.next(last);
+        const int removeGain = graph->getWeight(a, first) + graph->getWeight(last, b) - graph->getWeight(a, b);
+        if (removeGain <= 0)
+        {
+            continue;
+        }
+
+        // The new edge (last, q) comes from the candidates of `last`
+        const int *candidates = neighbors.get(last);
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            const int q = candidates[i];
+            const int lastQ = graph->getWeight(last, q);
+            if (lastQ >= removeGain)
+            {
+                break;
+            }
+            if (q == b || tour.between(first, q, last))
+            {
+                continue;
+            }
+
+            const int p = tour.prev(q);
+            const int delta = graph->getWeight(p, first) + lastQ - graph->getWeight(p, q) - removeGain;
+            if (delta < 0)
+            {
+                tour.moveSegment(first, last, p);
+                currentPathWeight += delta;
+
+                activate(a);
+                activate(b);
+                activate(p);
+                activate(q);
+                activate(first);
+                activate(last);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <class Tour>
+void LinKernighan<Tour>::kick()
+{
+    // Three cut points a, b, c along the tour, at most KICK_SEGMENT_LENGTH apart
+    const int maxLength = std::max(1, std::min(KICK_SEGMENT_LENGTH, (graphSize - 1) / 3));
+    const int a = rng.nextInt(graphSize);
+    int b = a;
+    for (int length = 1 + rng.nextInt(maxLength); length > 0; --length)
+    {
+        b = tour.next(b);
+    }
+    int c = b;
+    for (int length = 1 + rng.nextInt(maxLength); length > 0; --length)
+    {
+        c = tour.next(c);
+    }
+    const int aNext = tour.next(a);
+    const int bNext = tour.next(b);
+    const int cNext = tour.next(c);
+
+    // a -> [aNext .. b] -> [bNext .. c] -> cNext  =>  a -> [bNext .. c] -> [aNext .. b] -> cNext
+    currentPathWeight += graph->getWeight(a, bNext) + graph->getWeight(c, aNext) + graph->getWeight(b, cNext) -
+                         graph->getWeight(a, aNext) - graph->getWeight(b, bNext) - graph->getWeight(c, cNext);
+    tour.doubleBridge(a, b, c);
+    ++kickCount;
+
+    activate(a);
+    activate(aNext);
+    activate(b);
+    activate(bNext);
+    activate(c);
+    activate(cNext);
+}
+
+template class LinKernighan<ArrayTour>;
+template class LinKernighan<TwoLevelListTour>;
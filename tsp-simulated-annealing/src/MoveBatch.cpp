@@ -0,0 +1,168 @@
+#include "MoveBatch.hpp"
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MOVE_BATCH_X86
+#endif
+
+static int invertDelta(GraphMatrix *graph, const int *path, int pathSize, int first, int last)
+{
+    // ... -> A -> B -> ... -> C -> D -> ...  =>  ... -> A -> C -> ... -> B -> D -> ...
+    const int a = path[first - 1];
+    const int b = path[first];
+    const int c = path[last];
+    const int d = path[last + 1 == pathSize ? 0 : last + 1];
+    return graph->getWeight(a, c) + graph->getWeight(b, d) - graph->getWeight(a, b) - graph->getWeight(c, d);
+}
+
+static int swapDelta(GraphMatrix *graph, const int *path, int pathSize, int first, int last)
+{
+    // ... -> A1 -> B1 -> C1 -> ... -> A2 -> B2 -> C2 -> ...  =>  ... -> A1 -> B2 -> C1 -> ... -> A2 -> B1 -> C2 -> ...
+    const int a1 = path[first - 1];
+    const int b1 = path[first];
+    const int c1 = path[first + 1];
+    const int a2 = path[last - 1];
+    const int b2 = path[last];
+    const int c2 = path[last + 1 == pathSize ? 0 : last + 1];
+    if (c1 == b2)
+    {
+        // ... -> A1 -> B1 -> B2 -> C2 -> ...
+        return graph->getWeight(a1, b2) + graph->getWeight(b2, b1) + graph->getWeight(b1, c2) -
+               graph->getWeight(a1, b1) - graph->getWeight(b1, b2) - graph->getWeight(b2, c2);
+    }
+    return graph->getWeight(a1, b2) + graph->getWeight(b2, c1) + graph->getWeight(a2, b1) + graph->getWeight(b1, c2) -
+           graph->getWeight(a1, b1) - graph->getWeight(b1, c1) - graph->getWeight(a2, b2) - graph->getWeight(b2, c2);
+}
+
+#ifdef MOVE_BATCH_X86
+
+// Gathers the weights of the edges (u[i], v[i]) of 8 lanes
+__attribute__((target("avx2"))) static inline __m256i gatherWeights(const int *weights, __m256i stride, __m256i u, __m256i v)
+{
+    const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(u, stride), v);
+    return _mm256_i32gather_epi32(weights, index, 4);
+}
+
+// Returns the indices following `index` in the cyclic path of `pathSize` vertices
+__attribute__((target("avx2"))) static inline __m256i nextPathIndex(__m256i index, __m256i pathSize)
+{
+    const __m256i next = _mm256_add_epi32(index, _mm256_set1_epi32(1));
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(next, pathSize), next);
+}
+
+__attribute__((target("avx2"))) static int invertDeltasAvx2(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas)
+{
+    const int *weights = graph->getWeights();
+    const __m256i stride = _mm256_set1_epi32(graph->getStride());
+    const __m256i pathSize = _mm256_set1_epi32(graph->getVertexCount());
+    const __m256i one = _mm256_set1_epi32(1);
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        const __m256i i = _mm256_loadu_si256((const __m256i *)(first + k));
+        const __m256i j = _mm256_loadu_si256((const __m256i *)(last + k));
+
+        const __m256i a = _mm256_i32gather_epi32(path, _mm256_sub_epi32(i, one), 4);
+        const __m256i b = _mm256_i32gather_epi32(path, i, 4);
+        const __m256i c = _mm256_i32gather_epi32(path, j, 4);
+        const __m256i d = _mm256_i32gather_epi32(path, nextPathIndex(j, pathSize), 4);
+
+        const __m256i added = _mm256_add_epi32(gatherWeights(weights, stride, a, c), gatherWeights(weights, stride, b, d));
+        const __m256i removed = _mm256_add_epi32(gatherWeights(weights, stride, a, b), gatherWeights(weights, stride, c, d));
+        _mm256_storeu_si256((__m256i *)(deltas + k), _mm256_sub_epi32(added, removed));
+    }
+    return k;
+}
+
+__attribute__((target("avx2"))) static int swapDeltasAvx2(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas)
+{
+    const int *weights = graph->getWeights();
+    const __m256i stride = _mm256_set1_epi32(graph->getStride());
+    const __m256i pathSize = _mm256_set1_epi32(graph->getVertexCount());
+    const __m256i one = _mm256_set1_epi32(1);
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        const __m256i i = _mm256_loadu_si256((const __m256i *)(first + k));
+        const __m256i j = _mm256_loadu_si256((const __m256i *)(last + k));
+
+        const __m256i a1 = _mm256_i32gather_epi32(path, _mm256_sub_epi32(i, one), 4);
+        const __m256i b1 = _mm256_i32gather_epi32(path, i, 4);
+        const __m256i c1 = _mm256_i32gather_epi32(path, _mm256_add_epi32(i, one), 4);
+        const __m256i a2 = _mm256_i32gather_epi32(path, _mm256_sub_epi32(j, one), 4);
+        const __m256i b2 = _mm256_i32gather_epi32(path, j, 4);
+        const __m256i c2 = _mm256_i32gather_epi32(path, nextPathIndex(j, pathSize), 4);
+
+        const __m256i added = _mm256_add_epi32(
+            _mm256_add_epi32(gatherWeights(weights, stride, a1, b2), gatherWeights(weights, stride, b2, c1)),
+            _mm256_add_epi32(gatherWeights(weights, stride, a2, b1), gatherWeights(weights, stride, b1, c2)));
+        const __m256i removed = _mm256_add_epi32(
+            _mm256_add_epi32(gatherWeights(weights, stride, a1, b1), gatherWeights(weights, stride, b1, c1)),
+            _mm256_add_epi32(gatherWeights(weights, stride, a2, b2), gatherWeights(weights, stride, b2, c2)));
+        _mm256_storeu_si256((__m256i *)(deltas + k), _mm256_sub_epi32(added, removed));
+    }
+
+    // Swaps of neighboring vertices share an edge, the general formula does not hold for them
+    for (int m = 0; m < k; ++m)
+    {
+        if (last[m] == first[m] + 1)
+        {
+            deltas[m] = swapDelta(graph, path, graph->getVertexCount(), first[m], last[m]);
+        }
+    }
+    return k;
+}
+
+#endif
+
+// Returns true if the AVX2 kernels can be used for `graph`
+static bool canUseAvx2(GraphMatrix *graph)
+{
+    // The gathers index the matrix with 32-bit offsets
+    return MoveBatch::usesAvx2() && (long)graph->getVertexCount() * graph->getStride() <= INT_MAX;
+}
+
+void MoveBatch::invertDeltas(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas)
+{
+    int k = 0;
+#ifdef MOVE_BATCH_X86
+    if (canUseAvx2(graph))
+    {
+        k = invertDeltasAvx2(graph, path, first, last, count, deltas);
+    }
+#endif
+    const int pathSize = graph->getVertexCount();
+    for (; k < count; ++k)
+    {
+        deltas[k] = invertDelta(graph, path, pathSize, first[k], last[k]);
+    }
+}
+
+void MoveBatch::swapDeltas(GraphMatrix *graph, const int *path, const int *first, const int *last, int count, int *deltas)
+{
+    int k = 0;
+#ifdef MOVE_BATCH_X86
+    if (canUseAvx2(graph))
+    {
+        k = swapDeltasAvx2(graph, path, first, last, count, deltas);
+    }
+#endif
+    const int pathSize = graph->getVertexCount();
+    for (; k < count; ++k)
+    {
+        deltas[k] = swapDelta(graph, path, pathSize, first[k], last[k]);
+    }
+}
+
+bool MoveBatch::usesAvx2()
+{
+#ifdef MOVE_BATCH_X86
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,40 @@
+#include "NeighborLists.hpp"
+#include <algorithm>
+
+NeighborLists::NeighborLists(GraphMatrix *graph, int k)
+{
+    vertexCount = graph->getVertexCount();
+    count = std::max(0, std::min(k, vertexCount - 1));
+    neighbors.resize(vertexCount * count);
+    if (count == 0)
+    {
+        return;
+    }
+
+    // The k nearest vertices found so far, sorted by the weight. One pass over the row, most of the
+    // vertices are rejected by a single comparison with the k-th weight (no sort of the whole row).
+    std::vector<int> nearestWeights(count);
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        int *nearest = &neighbors[v * count];
+        int found = 0;
+        for (int u = 0; u < vertexCount; ++u)
+        {
+            const int weight = graph->getWeight(v, u);
+            if (u == v || (found == count && weight >= nearestWeights[count - 1]))
+            {
+                continue;
+            }
+
+            // Insertion, an equal weight keeps the vertex found first
+            int i = found < count ? found++ : count - 1;
+            for (; i > 0 && nearestWeights[i - 1] > weight; --i)
+            {
+                nearestWeights[i] = nearestWeights[i - 1];
+                nearest[i] = nearest[i - 1];
+            }
+            nearestWeights[i] = weight;
+            nearest[i] = u;
+        }
+    }
+}
@@ -0,0 +1,179 @@
+#include "ParallelTempering.hpp"
+#include <thread>
+#include <cmath>
+
+ParallelTempering::ParallelTempering(GraphMatrix *graph, AlgorithmParams params)
+{
+    this->graph = graph;
+    this->params = params;
+
+    replicaCount = params.parallelTempering.replicas;
+    if (replicaCount <= 0)
+    {
+        replicaCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    rng.setSeed(rand());
+    for (int i = 0; i < replicaCount; ++i)
+    {
+        SimulatedAnnealing *replica = new SimulatedAnnealing(graph, params);
+        replica->setSharedBest(&best);
+        replicas.push_back(replica);
+    }
+}
+
+ParallelTempering::~ParallelTempering()
+{
+    for (SimulatedAnnealing *replica : replicas)
+    {
+        delete replica;
+    }
+}
+
+void ParallelTempering::setTrace(Trace *trace)
+{
+    this->trace = trace;
+}
+
+void ParallelTempering::initLadder(double maxTemperature)
+{
+    ladder.resize(replicaCount);
+    replicaAtLevel.resize(replicaCount);
+    levelOfReplica.resize(replicaCount);
+
+    // T_k = T_max * ratio^(k / (count - 1))
+    const double step = replicaCount > 1 ? std::pow(params.parallelTempering.temperatureRatio, 1.0 / (replicaCount - 1)) : 1.0;
+    double temperature = maxTemperature;
+    for (int level = 0; level < replicaCount; ++level)
+    {
+        ladder[level] = temperature;
+        replicaAtLevel[level] = level;
+        levelOfReplica[level] = level;
+        temperature *= step;
+    }
+}
+
+Path ParallelTempering::solveTSP()
+{
+    for (SimulatedAnnealing *replica : replicas)
+    {
+        replica->initialize();
+    }
+    initLadder(replicas[0]->getInitialTemperature());
+
+    printf("Parallel tempering: %i replicas, temperatures %f - %f\n", replicaCount, ladder.front(), ladder.back());
+
+    stop = false;
+    keepRunning = true;
+    waitingCount = 0;
+    exchangeRound = 0;
+    exchangeAttempts = 0;
+    exchangesAccepted = 0;
+    if (trace != NULL)
+    {
+        trace->startRun();
+    }
+    timer.start();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < replicaCount; ++i)
+    {
+        threads.push_back(std::thread(&ParallelTempering::runReplica, this, i));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    printf("The execution time limit has been reached\n");
+    printf("Exchanges accepted: %li / %li\n", exchangesAccepted, exchangeAttempts);
+
+    std::vector<int> bestPath = best.getPath();
+    const int bestWeight = best.getWeight();
+    const int optimum = graph->getOptimum();
+    const float prd = (100.0 * (bestWeight - optimum)) / optimum;
+    return Path(bestPath, bestWeight, prd);
+}
+
+void ParallelTempering::runReplica(int replicaIndex)
+{
+    SimulatedAnnealing *replica = replicas[replicaIndex];
+    const int exchangeInterval = params.parallelTempering.exchangeInterval;
+
+    replica->startTimer();
+    bool running = true;
+    while (running)
+    {
+        // The level may only change inside synchronize(), while this replica is waiting
+        const double temperature = ladder[levelOfReplica[replicaIndex]];
+        const bool inTime = replica->runChain(exchangeInterval, temperature);
+        running = synchronize(!inTime);
+    }
+}
+
+bool ParallelTempering::synchronize(bool timeLimitReached)
+{
+    std::unique_lock<std::mutex> lock(barrierMutex);
+    if (timeLimitReached)
+    {
+        stop = true;
+    }
+
+    if (++waitingCount == replicaCount)
+    {
+        // The last replica to arrive performs the exchange and releases the others
+        waitingCount = 0;
+        ++barrierGeneration;
+        // `stop` may be set by a replica arriving at the next barrier before all the replicas
+        // have woken up, so the decision is taken here, once per barrier
+        keepRunning = !stop;
+        if (keepRunning)
+        {
+            exchangeStates();
+        }
+        barrierCondition.notify_all();
+    }
+    else
+    {
+        const unsigned long generation = barrierGeneration;
+        barrierCondition.wait(lock, [this, generation]
+                              { return barrierGeneration != generation; });
+    }
+    return keepRunning;
+}
+
+void ParallelTempering::exchangeStates()
+{
+    for (int level = exchangeRound % 2; level + 1 < replicaCount; level += 2)
+    {
+        const int hot = replicaAtLevel[level];
+        const int cold = replicaAtLevel[level + 1];
+
+        // Accept with probability min(1, exp((1/T_hot - 1/T_cold) * (E_hot - E_cold)))
+        const double betaDifference = 1.0 / ladder[level] - 1.0 / ladder[level + 1];
+        const double energyDifference = replicas[hot]->getCurrentWeight() - replicas[cold]->getCurrentWeight();
+        const double exponent = betaDifference * energyDifference;
+
+        ++exchangeAttempts;
+        if (exponent >= 0.0 || std::exp(exponent) > rng.nextDouble())
+        {
+            replicaAtLevel[level] = cold;
+            replicaAtLevel[level + 1] = hot;
+            levelOfReplica[cold] = level;
+            levelOfReplica[hot] = level + 1;
+            ++exchangesAccepted;
+        }
+    }
+    ++exchangeRound;
+
+    if (trace != NULL)
+    {
+        const unsigned long elapsedMs = timer.getElapsedMs();
+        const long long iteration = (long long)exchangeRound * params.parallelTempering.exchangeInterval;
+        if (trace->isDue(iteration, elapsedMs))
+        {
+            SimulatedAnnealing *coldest = replicas[replicaAtLevel[replicaCount - 1]];
+            trace->sample(iteration, elapsedMs, ladder[replicaCount - 1], coldest->getCurrentWeight(), best.getWeight());
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#include "SharedBest.hpp"
+
+bool SharedBest::offer(const int *path, int size, int weight)
+{
+    if (weight >= getWeight())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (weight >= this->weight.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    this->path.assign(path, path + size);
+    this->weight.store(weight, std::memory_order_relaxed);
+    if (weight <= target)
+    {
+        targetReached.store(true, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+std::vector<int> SharedBest::getPath()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return path;
+}
@@ -1,15 +1,51 @@
 #include "SimulatedAnnealing.hpp"
+#include "MoveBatch.hpp"
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <climits>
 
-SimulatedAnnealing::SimulatedAnnealing(GraphMatrix *graph, AlgorithmParams params) : TSPAlgorithm(graph)
+// Number of random moves sampled to estimate the initial temperature
+static const int INITIAL_TEMPERATURE_SAMPLES = 1000;
+// Bounds of the temperature change at the end of an adaptive chain
+static const double MIN_ADAPTIVE_FACTOR = 0.5;
+static const double MAX_ADAPTIVE_FACTOR = 2.0;
+
+SimulatedAnnealing::SimulatedAnnealing(GraphMatrix *graph, AlgorithmParams params, SolveContext *context) : TSPAlgorithm(graph, context)
 {
     this->maxNoImprovementIters = 20000 * graph->getVertexCount();
     this->maxExecutionTime = params.maxExecutionTimeMs;
     this->initialPathMode = params.initialPathMode;
     this->neighborMode = params.neighborMode;
+    this->moveProbabilities = params.moveProbabilities;
     this->temperatureCoefficient = params.temperatureCoefficient;
     this->coolingRate = params.coolingRate;
+    this->cooling = params.cooling;
+
+    // The adaptive schedule spreads the search over the whole execution time and reheating restarts
+    // stagnated searches, so neither is stopped by the no improvement limit
+    if (cooling.schedule == AdaptiveCooling || cooling.reheatAfterFactor > 0)
+    {
+        this->maxNoImprovementIters = INT_MAX;
+    }
+
+    if (params.moveBatch.size > 1 && graphSize >= 3)
+    {
+        // Reversals of directed paths cost O(part length) and the other moves are drawn one by one
+        if (neighborMode == Swap || (neighborMode == Invert && !graph->directed))
+        {
+            batchSize = params.moveBatch.size;
+            bestOfBatchRatio = params.moveBatch.bestOfBatchRatio;
+            this->context->reserveBatch(batchSize);
+            batchFirst = this->context->batchFirst.data();
+            batchLast = this->context->batchLast.data();
+            batchDeltas = this->context->batchDeltas.data();
+        }
+        else
+        {
+            printf("Move batches support the swap moves and the invert moves of undirected graphs only\n");
+        }
+    }
 }
 
 double SimulatedAnnealing::getAverageEdgeWeight()
@@ -49,46 +85,263 @@ double SimulatedAnnealing::getEdgeWeightAAD()
     return deviationSum / numberOfEdges;
 }
 
+double SimulatedAnnealing::getSampledInitialTemperature()
+{
+    double worseningSum = 0.0;
+    int worseningCount = 0;
+    for (int i = 0; i < INITIAL_TEMPERATURE_SAMPLES; ++i)
+    {
+        // The moves are only evaluated, never applied
+        getNextPathPermutation();
+        if (nextPathWeight > currentPathWeight)
+        {
+            worseningSum += nextPathWeight - currentPathWeight;
+            ++worseningCount;
+        }
+    }
+    if (worseningCount == 0)
+    {
+        return 0.0;
+    }
+
+    // exp(-averageWorsening / T0) = initialAcceptance
+    const double averageWorsening = worseningSum / worseningCount;
+    return -averageWorsening / log(cooling.initialAcceptance);
+}
+
 double SimulatedAnnealing::getInitialTemperature()
 {
+    if (cooling.initialTemperatureMode == SampledTemperature)
+    {
+        const double sampled = getSampledInitialTemperature();
+        if (sampled > 0.0)
+        {
+            return sampled;
+        }
+    }
     double averageDeviation = getEdgeWeightAAD();
     return temperatureCoefficient * averageDeviation;
 }
 
-Path SimulatedAnnealing::solveTSP()
+void SimulatedAnnealing::startCooling()
+{
+    initialTemperature = getInitialTemperature();
+    temperature = initialTemperature;
+
+    lundyMeesBeta = cooling.lundyMeesCoefficient / initialTemperature;
+    chainLength = std::max(1, cooling.chainLengthFactor * graphSize);
+    chainIteration = 0;
+    chainAccepted = 0;
+    reheatAfter = cooling.reheatAfterFactor * graphSize;
+    stagnationIters = 0;
+    reheatCount = 0;
+}
+
+void SimulatedAnnealing::updateTemperature(bool accepted)
+{
+    switch (cooling.schedule)
+    {
+    case GeometricCooling:
+        temperature *= coolingRate;
+        break;
+    case LundyMeesCooling:
+        temperature = temperature / (1.0 + lundyMeesBeta * temperature);
+        break;
+    default:
+        chainAccepted += accepted;
+        if (++chainIteration >= chainLength)
+        {
+            if (cooling.schedule == MarkovChainCooling)
+            {
+                temperature *= cooling.chainCoolingRate;
+            }
+            else
+            {
+                adaptTemperature();
+            }
+            chainIteration = 0;
+            chainAccepted = 0;
+        }
+        break;
+    }
+
+    if (reheatAfter > 0 && ++stagnationIters >= reheatAfter)
+    {
+        temperature = std::max(temperature, cooling.reheatRatio * initialTemperature);
+        stagnationIters = 0;
+        ++reheatCount;
+    }
+}
+
+void SimulatedAnnealing::adaptTemperature()
 {
+    // The target decreases geometrically from the initial to the final acceptance ratio over the time budget
+    const double progress = std::min(1.0, (double)elapsedMs / maxExecutionTime);
+    const double target = cooling.initialTargetAcceptance *
+                          pow(cooling.finalTargetAcceptance / cooling.initialTargetAcceptance, progress);
+    const double ratio = (double)chainAccepted / chainLength;
 
+    // Cool down when accepting too much, heat up when accepting too little
+    double factor = exp((target - ratio) / target);
+    factor = std::min(MAX_ADAPTIVE_FACTOR, std::max(MIN_ADAPTIVE_FACTOR, factor));
+    temperature *= factor;
+}
+
+void SimulatedAnnealing::initialize()
+{
     setInitialPath();
 
     this->currentPathWeight = getCurrentPathWeight();
     this->initialPathWeight = currentPathWeight;
     this->bestFoundPathWeight = currentPathWeight;
-    printImprovement(0, currentPathWeight);
+    this->iteration = 0;
+    this->noImprovementIters = 0;
+    this->stagnationIters = 0;
+
+    if (sharedBest != NULL)
+    {
+        sharedBest->offer(bestFoundPath, graphSize, bestFoundPathWeight);
+    }
+}
 
-    // printPath(currentPath);
-    // printf("Initial path weight: %i\n", currentPathWeight);
+Path SimulatedAnnealing::solveTSP()
+{
+    if (resumed)
+    {
+        printf("Resumed at iteration %lli after %lu ms, best path weight: %i\n", iteration, resumedElapsedMs, bestFoundPathWeight);
+    }
+    else
+    {
+        initialize();
+        printImprovement(0, currentPathWeight);
+
+        // printPath(currentPath);
+        // printf("Initial path weight: %i\n", currentPathWeight);
 
-    double temperature = getInitialTemperature();
+        startCooling();
+    }
 
-    iteration = 0;
-    timer.start();
+    if (trace != NULL)
+    {
+        trace->startRun();
+    }
+    startTimer();
+    batchPosition = batchSize;
     do
     {
-        temperature = temperature * coolingRate;
-        printf("temp: %f\n", temperature);
-
-        getNextPathPermutation();
+        if (batchSize > 0)
+        {
+            getNextBatchedMove();
+        }
+        else
+        {
+            getNextPathPermutation();
+        }
 
-        if (transitionProbability(temperature) > randomDouble())
+        const bool accepted = transitionProbability(temperature) > randomDouble();
+        if (accepted)
         {
             acceptNextPath();
         }
+        updateTemperature(accepted);
         ++iteration;
         ++noImprovementIters;
+
+        if (trace != NULL && trace->isDue(iteration, elapsedMs))
+        {
+            trace->sample(iteration, elapsedMs, temperature, currentPathWeight, bestFoundPathWeight);
+        }
+        if (checkpoint != NULL && checkpoint->isDue(elapsedMs))
+        {
+            saveCheckpoint();
+        }
     } while (!endCriterionIsMet());
     // printImprovement(0, initialPathWeight);
+    if (reheatCount > 0)
+    {
+        printf("Reheats: %i\n", reheatCount);
+    }
     printPath(bestFoundPath);
 
+    return getBestFoundPath();
+}
+
+void SimulatedAnnealing::setCheckpoint(Checkpoint *checkpoint)
+{
+    this->checkpoint = checkpoint;
+}
+
+void SimulatedAnnealing::saveCheckpoint()
+{
+    checkpoint->save(elapsedMs, [this](SolverState &state)
+                     {
+        state.elapsedMs = resumedElapsedMs + elapsedMs;
+        rng.getState(state.rngState);
+        state.iteration = iteration;
+        state.noImprovementIters = noImprovementIters;
+        state.initialPathWeight = initialPathWeight;
+        state.currentPathWeight = currentPathWeight;
+        state.bestFoundPathWeight = bestFoundPathWeight;
+        state.temperature = temperature;
+        state.initialTemperature = initialTemperature;
+        state.lundyMeesBeta = lundyMeesBeta;
+        state.chainLength = chainLength;
+        state.chainIteration = chainIteration;
+        state.chainAccepted = chainAccepted;
+        state.reheatAfter = reheatAfter;
+        state.stagnationIters = stagnationIters;
+        state.reheatCount = reheatCount;
+        state.currentPath.assign(currentPath, currentPath + graphSize);
+        state.bestFoundPath.assign(bestFoundPath, bestFoundPath + graphSize); });
+}
+
+void SimulatedAnnealing::resume(const SolverState &state)
+{
+    resumed = true;
+    resumedElapsedMs = state.elapsedMs;
+    this->maxExecutionTime = std::max(0L, (long)maxExecutionTime - (long)state.elapsedMs);
+
+    rng.setState(state.rngState);
+    iteration = state.iteration;
+    noImprovementIters = state.noImprovementIters;
+    initialPathWeight = state.initialPathWeight;
+    currentPathWeight = state.currentPathWeight;
+    bestFoundPathWeight = state.bestFoundPathWeight;
+    temperature = state.temperature;
+    initialTemperature = state.initialTemperature;
+    lundyMeesBeta = state.lundyMeesBeta;
+    chainLength = state.chainLength;
+    chainIteration = state.chainIteration;
+    chainAccepted = state.chainAccepted;
+    reheatAfter = state.reheatAfter;
+    stagnationIters = state.stagnationIters;
+    reheatCount = state.reheatCount;
+    std::copy(state.currentPath.begin(), state.currentPath.end(), currentPath);
+    std::copy(state.bestFoundPath.begin(), state.bestFoundPath.end(), bestFoundPath);
+}
+
+bool SimulatedAnnealing::runChain(int steps, double temperature)
+{
+    for (int i = 0; i < steps; ++i)
+    {
+        getNextPathPermutation();
+
+        if (transitionProbability(temperature) > randomDouble())
+        {
+            acceptNextPath();
+        }
+        ++iteration;
+
+        if (--itersUntilTimeCheck <= 0 && executionTimeLimit())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+Path SimulatedAnnealing::getBestFoundPath()
+{
     float prd = getPrd(bestFoundPathWeight);
     std::vector<int> resPath(graphSize);
     for (int i = 0; i < graphSize; ++i)
@@ -100,20 +353,141 @@ Path SimulatedAnnealing::solveTSP()
 
 void SimulatedAnnealing::getNextPathPermutation()
 {
-    int index1 = 1 + random() % (graphSize - 2);
-    int index2 = index1 + 1 + random() % (graphSize - index1 - 1);
+    const NeighborMode mode = neighborMode == Mixed ? drawNeighborMode() : neighborMode;
 
-    switch (neighborMode)
+    switch (mode)
     {
-    case Swap:
-        swap(index1, index2);
+    case OrOpt:
+        getSegmentMove(1 + rng.nextInt(std::min(3, graphSize - 2)), rng.nextInt(2) == 1, OrOpt);
         break;
-    case Invert:
-        invert(index1, index2);
+    case Or2Opt:
+        // Reversing a long segment of a directed graph would cost O(segment length)
+        getSegmentMove(1 + rng.nextInt(std::max(1, graphSize / 2)), !graph->directed && rng.nextInt(2) == 1, Or2Opt);
         break;
+    default:
+    {
+        int index1 = 1 + rng.nextInt(graphSize - 2);
+        int index2 = index1 + 1 + rng.nextInt(graphSize - index1 - 1);
+
+        if (mode == Swap)
+        {
+            swap(index1, index2);
+        }
+        else
+        {
+            invert(index1, index2);
+        }
+        break;
+    }
+    }
+}
+
+void SimulatedAnnealing::getNextBatchedMove()
+{
+    int best;
+    if (bestOfBatchRatio > 0.0 && temperature < bestOfBatchRatio * initialTemperature)
+    {
+        evaluateBatch();
+        best = 0;
+        for (int k = 1; k < batchSize; ++k)
+        {
+            if (batchDeltas[k] < batchDeltas[best])
+            {
+                best = k;
+            }
+        }
+        batchPosition = batchSize;
+    }
+    else
+    {
+        if (batchPosition == batchSize)
+        {
+            evaluateBatch();
+            batchPosition = 0;
+        }
+        best = batchPosition++;
+
+        if (isStale(batchFirst[best], batchLast[best]))
+        {
+            if (neighborMode == Swap)
+            {
+                swap(batchFirst[best], batchLast[best]);
+            }
+            else
+            {
+                invert(batchFirst[best], batchLast[best]);
+            }
+            return;
+        }
+    }
+
+    nextMove = Move(neighborMode, batchFirst[best], batchLast[best]);
+    nextPathWeight = currentPathWeight + batchDeltas[best];
+}
+
+bool SimulatedAnnealing::isStale(int first, int last)
+{
+    // Invert depends on the positions first - 1, first, last, last + 1, swap also on first + 1 and last - 1
+    const int margin = neighborMode == Swap ? 1 : 0;
+    return (first - 1 <= changedLast && first + margin >= changedFirst) ||
+           (last - margin <= changedLast && last + 1 >= changedFirst);
+}
+
+void SimulatedAnnealing::evaluateBatch()
+{
+    changedFirst = graphSize;
+    changedLast = -1;
+    for (int k = 0; k < batchSize; ++k)
+    {
+        batchFirst[k] = 1 + rng.nextInt(graphSize - 2);
+        batchLast[k] = batchFirst[k] + 1 + rng.nextInt(graphSize - batchFirst[k] - 1);
+    }
+
+    if (neighborMode == Swap)
+    {
+        MoveBatch::swapDeltas(graph, currentPath, batchFirst, batchLast, batchSize, batchDeltas);
+    }
+    else
+    {
+        MoveBatch::invertDeltas(graph, currentPath, batchFirst, batchLast, batchSize, batchDeltas);
     }
 }
 
+void SimulatedAnnealing::getSegmentMove(int length, bool reversed, NeighborMode mode)
+{
+    const int first = 1 + rng.nextInt(graphSize - length);
+    const int last = first + length - 1;
+
+    // Draw the index after which the segment is inserted from [0, first - 2] and [last + 1, graphSize - 1]
+    int index = rng.nextInt(graphSize - length - 1);
+    if (index >= first - 1)
+    {
+        index += length + 1;
+    }
+
+    moveSegment(first, last, index, reversed, mode);
+}
+
+NeighborMode SimulatedAnnealing::drawNeighborMode()
+{
+    const double total = moveProbabilities.swap + moveProbabilities.invert + moveProbabilities.orOpt + moveProbabilities.or2Opt;
+    double value = rng.nextDouble() * total;
+
+    if ((value -= moveProbabilities.swap) < 0.0)
+    {
+        return Swap;
+    }
+    if ((value -= moveProbabilities.invert) < 0.0)
+    {
+        return Invert;
+    }
+    if ((value -= moveProbabilities.orOpt) < 0.0)
+    {
+        return OrOpt;
+    }
+    return Or2Opt;
+}
+
 double SimulatedAnnealing::transitionProbability(double temperature)
 {
     if (nextPathWeight < currentPathWeight)
@@ -129,8 +503,13 @@ double SimulatedAnnealing::transitionProbability(double temperature)
 
 void SimulatedAnnealing::acceptNextPath()
 {
-    copyPath(nextPath, currentPath);
+    applyNextMove();
     currentPathWeight = nextPathWeight;
+    if (batchSize > 0)
+    {
+        changedFirst = std::min(changedFirst, nextMove.index1);
+        changedLast = std::max(changedLast, nextMove.index2);
+    }
 
     if (currentPathWeight < bestFoundPathWeight)
     {
@@ -139,7 +518,11 @@ void SimulatedAnnealing::acceptNextPath()
 
         // printf("ItersWithoutImprovement: %i\n", itersWithoutImprovement);
 
-        printImprovement(iteration, bestFoundPathWeight);
+        if (sharedBest == NULL || sharedBest->offer(bestFoundPath, graphSize, bestFoundPathWeight))
+        {
+            printImprovement(iteration, bestFoundPathWeight);
+        }
         noImprovementIters = 0;
+        stagnationIters = 0;
     }
 }
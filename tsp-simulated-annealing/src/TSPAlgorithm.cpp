@@ -1,36 +1,103 @@
 
 #include "TSPAlgorithm.hpp"
+#include "TourConstruction.hpp"
 #include <algorithm>
 #include <numeric>
 #include <iterator>
+#include <cassert>
 
-TSPAlgorithm::TSPAlgorithm(GraphMatrix *graph)
+// Target period between two reads of the clock [ns].
+// Keeps the execution time limit accurate to well under 1 ms.
+static const unsigned long TIME_CHECK_PERIOD_NS = 250000;
+static const int MAX_TIME_CHECK_INTERVAL = 1 << 20;
+// Number of candidates of every vertex for the construction of the initial path (when the algorithm has no candidate lists)
+static const int CONSTRUCTION_NEIGHBOR_COUNT = 10;
+
+TSPAlgorithm::TSPAlgorithm(GraphMatrix *graph, SolveContext *context)
 {
     this->graph = graph;
     this->graphSize = graph->getVertexCount();
-    this->currentPath = new int[graphSize];
-    this->nextPath = new int[graphSize];
-    this->bestFoundPath = new int[graphSize];
-}
-
-TSPAlgorithm::~TSPAlgorithm()
-{
-    delete[] currentPath;
-    delete[] nextPath;
-    delete[] bestFoundPath;
+    this->context = context != NULL ? context : &ownedContext;
+    this->context->reserve(graphSize);
+    this->currentPath = this->context->currentPath.data();
+    this->bestFoundPath = this->context->bestFoundPath.data();
+    this->rng.setSeed(rand());
 }
 
 void TSPAlgorithm::setInitialPath()
 {
+    Timer constructionTimer;
+    constructionTimer.start();
+
     if (initialPathMode == Greedy)
     {
         initialPathGreedy();
     }
-    else
+    else if (initialPathMode == InOrder)
     {
         initialPathInOrder();
     }
+    else
+    {
+        initialPathFromCandidates();
+    }
     copyPath(currentPath, bestFoundPath);
+
+    // The concurrent runs of a multi-start test or the replicas of parallel tempering would print one line each
+    if (sharedBest != NULL)
+    {
+        return;
+    }
+    const double constructionMs = constructionTimer.getElapsedNs() / 1e6;
+    const char *modeNames[] = {"greedy", "in order", "nearest neighbor", "greedy edge", "MST doubling", "space-filling curve"};
+    const int weight = getCurrentPathWeight();
+    if (graph->isOptimumKnown())
+    {
+        printf("Initial path (%s): %i (%.2f%%), constructed in %.3f ms\n", modeNames[initialPathMode], weight, getPrd(weight), constructionMs);
+    }
+    else
+    {
+        printf("Initial path (%s): %i, constructed in %.3f ms\n", modeNames[initialPathMode], weight, constructionMs);
+    }
+}
+
+void TSPAlgorithm::initialPathFromCandidates()
+{
+    NeighborLists *neighbors = constructionNeighbors;
+    if (neighbors == NULL)
+    {
+        neighbors = new NeighborLists(graph, CONSTRUCTION_NEIGHBOR_COUNT);
+    }
+
+    const int firstVertex = rng.nextInt(graphSize);
+    if (initialPathMode == GreedyEdge)
+    {
+        TourConstruction::greedyEdge(graph, *neighbors, firstVertex, currentPath);
+    }
+    else if (initialPathMode == MstDoubling)
+    {
+        TourConstruction::mstDoubling(graph, *neighbors, firstVertex, currentPath);
+    }
+    else if (initialPathMode == SpaceFillingCurve)
+    {
+        if (!TourConstruction::spaceFillingCurve(graph, currentPath))
+        {
+            if (sharedBest == NULL)
+            {
+                printf("The graph has no coordinates, using nearest neighbor\n");
+            }
+            TourConstruction::nearestNeighbor(graph, *neighbors, firstVertex, currentPath);
+        }
+    }
+    else
+    {
+        TourConstruction::nearestNeighbor(graph, *neighbors, firstVertex, currentPath);
+    }
+
+    if (neighbors != constructionNeighbors)
+    {
+        delete neighbors;
+    }
 }
 
 void TSPAlgorithm::initialPathInOrder()
@@ -43,39 +110,37 @@ void TSPAlgorithm::initialPathInOrder()
 
 void TSPAlgorithm::initialPathGreedy()
 {
-    // Array holding information about available vertices
-    bool availableVerices[graphSize];
+    // The bits of the visited vertices
+    context->clearVertexBits(graphSize);
 
-    for (int i = 0; i < graphSize; ++i)
-    {
-        availableVerices[i] = true;
-    }
-
-    const int firstVertex = random() % graphSize;
+    const int firstVertex = rng.nextInt(graphSize);
 
     currentPath[0] = firstVertex;
-    availableVerices[firstVertex] = false;
+    context->setVertex(firstVertex);
 
     for (int i = 1; i < graphSize; ++i)
     {
 
         int minPathWeight = INT_MAX;
-        int closestVertex;
+        int closestVertex = -1;
         for (int j = 0; j < graphSize; ++j)
         {
-            if (availableVerices[j])
+            if (!context->isVertexSet(j))
             {
                 int edgeWeight = graph->getWeight(currentPath[i - 1], j);
-                if (edgeWeight < minPathWeight)
+                // The first unvisited vertex is taken even if its weight is INT_MAX
+                if (closestVertex < 0 || edgeWeight < minPathWeight)
                 {
                     minPathWeight = edgeWeight;
                     closestVertex = j;
                 }
             }
         }
+        // i < graphSize, so a vertex is still unvisited
+        assert(closestVertex >= 0);
 
         currentPath[i] = closestVertex;
-        availableVerices[closestVertex] = false;
+        context->setVertex(closestVertex);
     }
 }
 
@@ -104,19 +169,17 @@ int TSPAlgorithm::getCurrentPathWeight()
 
 int TSPAlgorithm::randomPathIndex()
 {
-    return rand() % graphSize;
+    return rng.nextInt(graphSize);
 }
 
-bool TSPAlgorithm::nextPathEqualToCurrent()
+int TSPAlgorithm::nextIndex(int index)
 {
-    for (int i = 0; i < graphSize; ++i)
-    {
-        if (currentPath[i] != nextPath[i])
-        {
-            return false;
-        }
-    }
-    return true;
+    return index + 1 == graphSize ? 0 : index + 1;
+}
+
+int TSPAlgorithm::prevIndex(int index)
+{
+    return index == 0 ? graphSize - 1 : index - 1;
 }
 
 void TSPAlgorithm::invert(int index1, int index2)
@@ -126,35 +189,15 @@ void TSPAlgorithm::invert(int index1, int index2)
         std::swap(index1, index2);
     }
 
-    for (int i = 0; i < graphSize; ++i)
-    {
-        if (i < index1 || i > index2)
-        {
-            nextPath[i] = currentPath[i];
-        }
-        else
-        {
-            nextPath[i] = currentPath[index2 - i + index1];
-        }
-    }
-
     nextPathWeight = currentPathWeight;
 
     // Path before invert: ... -> A -> B -> ... -> C -> D -> ...
     // Path after invert:  ... -> A -> C -> ... -> B -> D -> ...
 
-    int A = index1 - 1;
-    if (A == -1)
-    {
-        A = graphSize - 1;
-    }
+    int A = prevIndex(index1);
     int B = index1;
     int C = index2;
-    int D = index2 + 1;
-    if (D == graphSize)
-    {
-        D = 0;
-    }
+    int D = nextIndex(index2);
 
     nextPathWeight -= getWeight(A, B);
     nextPathWeight -= getWeight(C, D);
@@ -169,12 +212,11 @@ void TSPAlgorithm::invert(int index1, int index2)
         for (int i = B; i < C; ++i)
         {
             nextPathWeight -= getWeight(i, i + 1);
-        }
-        for (int i = C; i > B; --i)
-        {
-            nextPathWeight += getWeight(i, i - 1);
+            nextPathWeight += getWeight(i + 1, i);
         }
     }
+
+    nextMove = Move(Invert, index1, index2);
 }
 
 void TSPAlgorithm::swap(int index1, int index2)
@@ -184,75 +226,114 @@ void TSPAlgorithm::swap(int index1, int index2)
         std::swap(index1, index2);
     }
 
-    // Copy current path into new path
-    for (int i = 0; i < graphSize; ++i)
-    {
-        nextPath[i] = currentPath[i];
-    }
-
-    // Swap vertex on index1 with vertex on index2
-    nextPath[index1] = currentPath[index2];
-    nextPath[index2] = currentPath[index1];
-
-    nextPathWeight = currentPathWeight;
-
     // Path before swap: ... -> A1 -> B1 -> C1 -> ... -> A2 -> B2 -> C2 ->
     // Path after swap:  ... -> A1 -> B2 -> C1 -> ... -> A2 -> B1 -> C2 ->
 
-    int A1 = index1 - 1;
-    if (A1 == -1)
-    {
-        A1 = graphSize - 1;
-    }
-    const int B1 = index1;
-    int C1 = index1 + 1;
-    if (C1 == graphSize)
+    const int A1 = currentPath[prevIndex(index1)];
+    const int B1 = currentPath[index1];
+    const int C1 = currentPath[nextIndex(index1)];
+
+    const int A2 = currentPath[prevIndex(index2)];
+    const int B2 = currentPath[index2];
+    const int C2 = currentPath[nextIndex(index2)];
+
+    int delta;
+    if (C1 == B2)
     {
-        C1 = 0;
+        // ... -> A1 -> B1 -> B2 -> C2 -> ...
+        delta = graph->getWeight(A1, B2) + graph->getWeight(B2, B1) + graph->getWeight(B1, C2) -
+                graph->getWeight(A1, B1) - graph->getWeight(B1, B2) - graph->getWeight(B2, C2);
     }
-
-    int A2 = index2 - 1;
-    if (A2 == -1)
+    else if (C2 == B1)
     {
-        A2 = graphSize - 1;
+        // The path wraps around: ... -> A2 -> B2 -> B1 -> C1 -> ...
+        delta = graph->getWeight(A2, B1) + graph->getWeight(B1, B2) + graph->getWeight(B2, C1) -
+                graph->getWeight(A2, B2) - graph->getWeight(B2, B1) - graph->getWeight(B1, C1);
     }
-    const int B2 = index2;
-    int C2 = index2 + 1;
-    if (C2 == graphSize)
+    else
     {
-        C2 = 0;
+        delta = graph->getWeight(A1, B2) + graph->getWeight(B2, C1) + graph->getWeight(A2, B1) + graph->getWeight(B1, C2) -
+                graph->getWeight(A1, B1) - graph->getWeight(B1, C1) - graph->getWeight(A2, B2) - graph->getWeight(B2, C2);
     }
 
-    // Remove old edges
-    nextPathWeight -= getWeight(A1, B1);
-    nextPathWeight -= getWeight(B1, C1);
+    nextPathWeight = currentPathWeight + delta;
+    nextMove = Move(Swap, index1, index2);
+}
 
-    if (C1 != B2)
-    {
-        nextPathWeight -= getWeight(A2, B2);
-    }
+void TSPAlgorithm::moveSegment(int first, int last, int index, bool reversed, NeighborMode mode)
+{
+    // Path before:  ... -> A -> [S ... E] -> B -> ... -> P -> Q -> ...
+    // Path after:   ... -> A -> B -> ... -> P -> [S ... E] -> Q -> ...
+    //      or:      ... -> A -> B -> ... -> P -> [E ... S] -> Q -> ...  (reversed)
 
-    nextPathWeight -= getWeight(B2, C2);
+    const int A = currentPath[first - 1];
+    const int S = currentPath[first];
+    const int E = currentPath[last];
+    const int B = currentPath[nextIndex(last)];
+    const int P = currentPath[index];
+    const int Q = currentPath[nextIndex(index)];
 
-    // Add new edges
-    nextPathWeight += getNextWeight(A1, B1);
-    nextPathWeight += getNextWeight(B1, C1);
+    const int head = reversed ? E : S;
+    const int tail = reversed ? S : E;
+
+    nextPathWeight = currentPathWeight;
+    nextPathWeight -= graph->getWeight(A, S) + graph->getWeight(E, B) + graph->getWeight(P, Q);
+    nextPathWeight += graph->getWeight(A, B) + graph->getWeight(P, head) + graph->getWeight(tail, Q);
 
-    if (C1 != B2)
+    // Reversing the segment of a directed graph changes the weights of its inner edges
+    if (reversed && graph->directed)
     {
-        nextPathWeight += getNextWeight(A2, B2);
+        for (int i = first; i < last; ++i)
+        {
+            nextPathWeight -= getWeight(i, i + 1);
+            nextPathWeight += getWeight(i + 1, i);
+        }
     }
-    nextPathWeight += getNextWeight(B2, C2);
+
+    nextMove = Move(mode, first, last, index, reversed);
 }
 
-int TSPAlgorithm::getWeight(int index1, int index2)
+void TSPAlgorithm::applyNextMove()
 {
-    return graph->getWeight(currentPath[index1], currentPath[index2]);
+    const Move &move = nextMove;
+    switch (move.mode)
+    {
+    case Swap:
+        std::swap(currentPath[move.index1], currentPath[move.index2]);
+        break;
+    case Invert:
+        std::reverse(currentPath + move.index1, currentPath + move.index2 + 1);
+        break;
+    default:
+    {
+        const int first = move.index1;
+        const int last = move.index2;
+        const int length = last - first + 1;
+        int segmentStart;
+        if (move.index3 > last)
+        {
+            // Shift the vertices between the segment and P back, the segment ends at P
+            std::rotate(currentPath + first, currentPath + last + 1, currentPath + move.index3 + 1);
+            segmentStart = move.index3 - length + 1;
+        }
+        else
+        {
+            // Shift the vertices between Q and the segment forward, the segment starts after P
+            std::rotate(currentPath + move.index3 + 1, currentPath + first, currentPath + last + 1);
+            segmentStart = move.index3 + 1;
+        }
+        if (move.reversed)
+        {
+            std::reverse(currentPath + segmentStart, currentPath + segmentStart + length);
+        }
+        break;
+    }
+    }
 }
 
-int TSPAlgorithm::getNextWeight(int index1, int index2)
+int TSPAlgorithm::getWeight(int index1, int index2)
 {
-    return graph->getWeight(nextPath[index1], nextPath[index2]);
+    return graph->getWeight(currentPath[index1], currentPath[index2]);
 }
 
 void TSPAlgorithm::printPath(int *path)
@@ -266,7 +347,7 @@ void TSPAlgorithm::printPath(int *path)
 
 double TSPAlgorithm::randomDouble()
 {
-    return ((double)rand() / (RAND_MAX));
+    return rng.nextDouble();
 }
 
 void TSPAlgorithm::copyPath(int *src, int *dest)
@@ -277,17 +358,52 @@ void TSPAlgorithm::copyPath(int *src, int *dest)
     }
 }
 
+void TSPAlgorithm::setTrace(Trace *trace)
+{
+    this->trace = trace;
+}
+
+void TSPAlgorithm::setSharedBest(SharedBest *sharedBest)
+{
+    this->sharedBest = sharedBest;
+}
+
+void TSPAlgorithm::setSeed(uint64_t seed)
+{
+    rng.setSeed(seed);
+}
+
+void TSPAlgorithm::startTimer()
+{
+    timeCheckInterval = 1;
+    itersUntilTimeCheck = 1;
+    lastTimeCheckNs = 0;
+    elapsedMs = 0;
+    timer.start();
+}
+
 bool TSPAlgorithm::endCriterionIsMet()
 {
+    if (noImprovementItersLimit())
+    {
+        printf("The limit for number of iteraions without improvement has been reached\n");
+        return true;
+    }
+
+    if (--itersUntilTimeCheck > 0)
+    {
+        return false;
+    }
+
     if (executionTimeLimit())
     {
         printf("The execution time limit has been reached\n");
         return true;
     }
 
-    if (noImprovementItersLimit())
+    if (sharedBest != NULL && sharedBest->isTargetReached())
     {
-        printf("The limit for number of iteraions without improvement has been reached\n");
+        printf("The target path weight has been reached by one of the parallel instances\n");
         return true;
     }
 
@@ -307,14 +423,34 @@ bool TSPAlgorithm::noImprovementItersLimit()
 
 bool TSPAlgorithm::executionTimeLimit()
 {
-    // printf("%lu ns\n", timer.getElapsedMillis());
-    return timer.getElapsedMs() > maxExecutionTime;
+    const unsigned long elapsedNs = timer.getElapsedNs();
+    calibrateTimeCheckInterval(elapsedNs);
+    elapsedMs = elapsedNs / 1000000;
+    return elapsedMs > (unsigned long)maxExecutionTime;
 }
 
-void TSPAlgorithm::printImprovement(int iteration, int pathWeight)
+void TSPAlgorithm::calibrateTimeCheckInterval(unsigned long elapsedNs)
+{
+    const unsigned long sinceLastCheckNs = elapsedNs - lastTimeCheckNs;
+    lastTimeCheckNs = elapsedNs;
+
+    // Scale the interval by the ratio of the target period to the measured one,
+    // growing at most 2x per check so a slow start does not overshoot the limit
+    long interval = 2L * timeCheckInterval;
+    if (sinceLastCheckNs > 0)
+    {
+        interval = std::min(interval, (long)(timeCheckInterval * TIME_CHECK_PERIOD_NS / sinceLastCheckNs));
+    }
+    interval = std::max(1L, std::min(interval, (long)MAX_TIME_CHECK_INTERVAL));
+
+    timeCheckInterval = interval;
+    itersUntilTimeCheck = timeCheckInterval;
+}
+
+void TSPAlgorithm::printImprovement(long long iteration, int pathWeight)
 {
     float prd = getPrd(pathWeight);
-    printf("%4i %4i %.2f%%\n", iteration, pathWeight, prd);
+    printf("%4lli %4i %.2f%%\n", iteration, pathWeight, prd);
 }
 
 float TSPAlgorithm::getPrd(int pathWeight)
@@ -325,17 +461,12 @@ float TSPAlgorithm::getPrd(int pathWeight)
 
 bool TSPAlgorithm::pathIsValid(int *path)
 {
-
+    context->clearVertexBits(graphSize);
     for (int i = 0; i < graphSize; i++)
     {
-        if (path[i] < 0 || path[i] >= graphSize)
+        if (path[i] < 0 || path[i] >= graphSize || context->isVertexSet(path[i]))
             return false;
+        context->setVertex(path[i]);
     }
-
-    int *pathCopy = new int[graphSize];
-    copyPath(path, pathCopy);
-    std::sort(pathCopy, pathCopy + graphSize);
-    auto pos = std::adjacent_find(pathCopy, pathCopy + graphSize);
-    delete[] pathCopy;
-    return pos == pathCopy + graphSize;
+    return true;
 }
@@ -0,0 +1,410 @@
+#include "TabuSearch.hpp"
+#include <algorithm>
+
+// Below this number of dirty vertices the evaluation is not split into parallel batches
+static const int PARALLEL_MIN_DIRTY_VERTICES = 512;
+
+const TabuSearch::MoveKey TabuSearch::NO_MOVE;
+
+TabuSearch::TabuSearch(GraphMatrix *graph, AlgorithmParams params)
+    : TSPAlgorithm(graph),
+      neighbors(graph, params.localSearch.neighborCount),
+      tour(graph->getVertexCount(), graph->directed)
+{
+    this->maxNoImprovementIters = INT_MAX;
+    this->maxExecutionTime = params.maxExecutionTimeMs;
+    this->initialPathMode = params.initialPathMode;
+    this->constructionNeighbors = &neighbors;
+
+    tenure = params.tabuSearch.tenure;
+    if (tenure <= 0)
+    {
+        tenure = std::max(10, std::min(50, graphSize / 4));
+    }
+
+    tabuUntil.resize(graphSize * graphSize);
+    // The tabu status set in iteration i ends at most in iteration i + tenure + tenure / 2
+    expiring.resize(tenure + tenure / 2 + 1);
+
+    // Counting sort of the candidate lists by the candidate
+    const int candidateCount = neighbors.getCount();
+    reverseStart.assign(graphSize + 1, 0);
+    for (int v = 0; v < graphSize; ++v)
+    {
+        const int *candidates = neighbors.get(v);
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            ++reverseStart[candidates[i] + 1];
+        }
+    }
+    for (int v = 0; v < graphSize; ++v)
+    {
+        reverseStart[v + 1] += reverseStart[v];
+    }
+    reverseNeighbors.resize(reverseStart[graphSize]);
+    std::vector<int> filled(reverseStart.begin(), reverseStart.end() - 1);
+    for (int v = 0; v < graphSize; ++v)
+    {
+        const int *candidates = neighbors.get(v);
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            reverseNeighbors[filled[candidates[i]]++] = v;
+        }
+    }
+
+    leafCount = 1;
+    while (leafCount < graphSize)
+    {
+        leafCount *= 2;
+    }
+    isDirty.resize(graphSize);
+
+    if (graphSize >= params.tabuSearch.parallelMinVertices)
+    {
+        pool = new ThreadPool(params.tabuSearch.threads);
+    }
+}
+
+TabuSearch::~TabuSearch()
+{
+    delete pool;
+}
+
+Path TabuSearch::solveTSP()
+{
+    setInitialPath();
+    currentPathWeight = getCurrentPathWeight();
+    initialPathWeight = currentPathWeight;
+    bestFoundPathWeight = currentPathWeight;
+    copyPath(currentPath, bestFoundPath);
+    printImprovement(0, currentPathWeight);
+
+    iteration = 0;
+    noImprovementIters = 0;
+    std::fill(tabuUntil.begin(), tabuUntil.end(), 0);
+    for (std::vector<int> &edges : expiring)
+    {
+        edges.clear();
+    }
+    tour.set(currentPath);
+
+    // The whole neighborhood is evaluated in the first iteration
+    allowedTree.assign(2 * leafCount, NO_MOVE);
+    tabuTree.assign(2 * leafCount, NO_MOVE);
+    dirtyVertices.clear();
+    std::fill(isDirty.begin(), isDirty.end(), false);
+    for (int v = 0; v < graphSize; ++v)
+    {
+        markChanged(v);
+    }
+    startTimer();
+
+    // Smaller paths have no moves changing them
+    while (graphSize >= 4 && !endCriterionIsMet())
+    {
+        releaseExpiredTabu();
+        evaluateDirtyVertices();
+        const TabuMove move = findBestMove();
+        if (move.delta != INT_MAX)
+        {
+            applyMove(move);
+        }
+        ++iteration;
+        ++noImprovementIters;
+
+        if (currentPathWeight < bestFoundPathWeight)
+        {
+            tour.copyTo(bestFoundPath);
+            bestFoundPathWeight = currentPathWeight;
+            if (sharedBest == NULL || sharedBest->offer(bestFoundPath, graphSize, bestFoundPathWeight))
+            {
+                printImprovement(iteration, bestFoundPathWeight);
+            }
+            noImprovementIters = 0;
+        }
+    }
+    printf("Tabu search iterations: %i, tenure: %i, time: %lu ms\n", iteration, tenure, timer.getElapsedMs());
+    printPath(bestFoundPath);
+
+    std::vector<int> resPath(bestFoundPath, bestFoundPath + graphSize);
+    return Path(resPath, bestFoundPathWeight, getPrd(bestFoundPathWeight));
+}
+
+void TabuSearch::setTabu(int u, int v)
+{
+    // A random part of the tenure prevents cycles of the same moves
+    const int until = iteration + tenure + rng.nextInt(tenure / 2 + 1);
+    tabuUntil[u * graphSize + v] = until;
+    if (!graph->directed)
+    {
+        tabuUntil[v * graphSize + u] = until;
+    }
+    expiring[until % expiring.size()].push_back(u * graphSize + v);
+    markAround(u);
+    markAround(v);
+}
+
+void TabuSearch::releaseExpiredTabu()
+{
+    std::vector<int> &edges = expiring[iteration % expiring.size()];
+    for (int edge : edges)
+    {
+        // Skipped if the edge was made tabu again later
+        if (tabuUntil[edge] == iteration)
+        {
+            markAround(edge / graphSize);
+            markAround(edge % graphSize);
+        }
+    }
+    edges.clear();
+}
+
+TabuSearch::MoveKey TabuSearch::moveKey(int delta, int a, int candidate, MoveKind kind)
+{
+    // The sign bit flipped, the unsigned order of the weight changes is their signed order
+    const uint32_t orderedDelta = (uint32_t)delta ^ 0x80000000u;
+    const uint32_t index = ((uint32_t)a * neighbors.getCount() + candidate) * MOVE_KIND_COUNT + kind;
+    return (MoveKey)orderedDelta << 32 | index;
+}
+
+TabuSearch::TabuMove TabuSearch::getMove(MoveKey key)
+{
+    TabuMove move;
+    if (key == NO_MOVE)
+    {
+        return move;
+    }
+    const uint32_t index = (uint32_t)key;
+    const int kind = index % MOVE_KIND_COUNT;
+    const int candidate = index / MOVE_KIND_COUNT % neighbors.getCount();
+    move.a = index / MOVE_KIND_COUNT / neighbors.getCount();
+    move.c = neighbors.get(move.a)[candidate];
+    move.type = kind == Insertion ? InsertMove : TwoOptMove;
+    move.successor = kind == SuccessorTwoOpt;
+    move.delta = (int)((uint32_t)(key >> 32) ^ 0x80000000u);
+    return move;
+}
+
+void TabuSearch::markChanged(int vertex)
+{
+    // On small graphs a move often marks all the vertices
+    if ((int)dirtyVertices.size() == graphSize)
+    {
+        return;
+    }
+    if (!isDirty[vertex])
+    {
+        isDirty[vertex] = true;
+        dirtyVertices.push_back(vertex);
+    }
+    for (int i = reverseStart[vertex]; i < reverseStart[vertex + 1]; ++i)
+    {
+        const int v = reverseNeighbors[i];
+        if (!isDirty[v])
+        {
+            isDirty[v] = true;
+            dirtyVertices.push_back(v);
+        }
+    }
+}
+
+void TabuSearch::markAround(int vertex)
+{
+    // A move from `a` with the candidate `c` adds edges between a, c and their prev / next
+    markChanged(vertex);
+    markChanged(tour.prev(vertex));
+    markChanged(tour.next(vertex));
+}
+
+TabuSearch::TabuMove TabuSearch::findBestMove()
+{
+    // The best tabu move is the only one which may aspire
+    const MoveKey allowed = allowedTree[1];
+    const MoveKey tabu = tabuTree[1];
+    if (tabu < allowed && aspires(getMove(tabu).delta))
+    {
+        return getMove(tabu);
+    }
+    return getMove(allowed);
+}
+
+void TabuSearch::evaluateDirtyVertices()
+{
+    const int dirtyCount = dirtyVertices.size();
+    if (pool == NULL || dirtyCount < PARALLEL_MIN_DIRTY_VERTICES)
+    {
+        evaluateBatch(0, dirtyCount);
+    }
+    else
+    {
+        const int batchCount = pool->getThreadCount();
+        for (int i = 0; i < batchCount; ++i)
+        {
+            const int from = (long)dirtyCount * i / batchCount;
+            const int to = (long)dirtyCount * (i + 1) / batchCount;
+            pool->submit([this, from, to]
+                         { evaluateBatch(from, to); });
+        }
+        pool->wait();
+    }
+
+    // Updating the paths from the leaves costs O(dirty * log n), rebuilding the trees O(n)
+    int depth = 0;
+    while ((1 << depth) < leafCount)
+    {
+        ++depth;
+    }
+    const bool rebuild = (long)dirtyCount * depth >= leafCount;
+    for (int a : dirtyVertices)
+    {
+        isDirty[a] = false;
+        for (int node = (leafCount + a) / 2; !rebuild && node >= 1; node /= 2)
+        {
+            allowedTree[node] = std::min(allowedTree[2 * node], allowedTree[2 * node + 1]);
+            tabuTree[node] = std::min(tabuTree[2 * node], tabuTree[2 * node + 1]);
+        }
+    }
+    for (int node = leafCount - 1; rebuild && node >= 1; --node)
+    {
+        allowedTree[node] = std::min(allowedTree[2 * node], allowedTree[2 * node + 1]);
+        tabuTree[node] = std::min(tabuTree[2 * node], tabuTree[2 * node + 1]);
+    }
+    dirtyVertices.clear();
+}
+
+void TabuSearch::evaluateBatch(int from, int to)
+{
+    for (int i = from; i < to; ++i)
+    {
+        evaluateVertex(dirtyVertices[i]);
+    }
+}
+
+void TabuSearch::evaluateVertex(int a)
+{
+    const int candidateCount = neighbors.getCount();
+    const int *candidates = neighbors.get(a);
+    const int aNext = tour.next(a);
+    const int aPrev = tour.prev(a);
+    MoveKey allowed = NO_MOVE;
+    MoveKey tabu = NO_MOVE;
+
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        const int c = candidates[i];
+        const int ac = graph->getWeight(a, c);
+        const int cNext = tour.next(c);
+        const int cPrev = tour.prev(c);
+
+        if (!graph->directed)
+        {
+            // Successor: ... a -> b ... c -> d ...  =>  ... a -> c ... b -> d ...
+            if (c != aNext && cNext != a)
+            {
+                const int delta = ac + graph->getWeight(aNext, cNext) - graph->getWeight(a, aNext) - graph->getWeight(c, cNext);
+                const MoveKey key = moveKey(delta, a, i, SuccessorTwoOpt);
+                if (key < allowed || (delta < 0 && key < tabu))
+                {
+                    MoveKey &best = isTabu(a, c) || isTabu(aNext, cNext) ? tabu : allowed;
+                    best = std::min(best, key);
+                }
+            }
+            // Predecessor: ... b -> a ... d -> c ...  =>  ... b -> d ... a -> c ...
+            if (c != aPrev && cPrev != a)
+            {
+                const int delta = ac + graph->getWeight(aPrev, cPrev) - graph->getWeight(aPrev, a) - graph->getWeight(cPrev, c);
+                const MoveKey key = moveKey(delta, a, i, PredecessorTwoOpt);
+                if (key < allowed || (delta < 0 && key < tabu))
+                {
+                    MoveKey &best = isTabu(a, c) || isTabu(aPrev, cPrev) ? tabu : allowed;
+                    best = std::min(best, key);
+                }
+            }
+        }
+
+        // Insertion: ... p -> c -> q ... a -> b ...  =>  ... p -> q ... a -> c -> b ...
+        if (c != aNext)
+        {
+            const int delta = ac + graph->getWeight(c, aNext) + graph->getWeight(cPrev, cNext) -
+                              graph->getWeight(a, aNext) - graph->getWeight(cPrev, c) - graph->getWeight(c, cNext);
+            const MoveKey key = moveKey(delta, a, i, Insertion);
+            // The tabu status is looked up only for a move better than one of the best two. The current path is never
+            // shorter than the best one, so only a tabu move shortening the path may aspire
+            if (key < allowed || (delta < 0 && key < tabu))
+            {
+                MoveKey &best = isTabu(a, c) || isTabu(c, aNext) || isTabu(cPrev, cNext) ? tabu : allowed;
+                best = std::min(best, key);
+            }
+        }
+    }
+    allowedTree[leafCount + a] = allowed;
+    tabuTree[leafCount + a] = tabu;
+}
+
+void TabuSearch::twoOptMove(int x, int y)
+{
+    const int xNext = tour.next(x);
+    const int yNext = tour.next(y);
+    tour.twoOptMove(x, y);
+
+    // The array reverses the shorter side: x -> y ... xNext -> yNext, or the rest: xNext ... y -> x ... yNext
+    int first = y;
+    int last = xNext;
+    if (tour.next(x) != y)
+    {
+        first = x;
+        last = yNext;
+    }
+    for (int v = first;; v = tour.next(v))
+    {
+        markChanged(v);
+        if (v == last)
+        {
+            break;
+        }
+    }
+    markChanged(x);
+    markChanged(xNext);
+    markChanged(y);
+    markChanged(yNext);
+}
+
+void TabuSearch::applyMove(const TabuMove &move)
+{
+    const int a = move.a;
+    const int c = move.c;
+
+    // The tabu status is set after the move, around the new neighbors of the vertices
+    if (move.type == TwoOptMove && move.successor)
+    {
+        const int b = tour.next(a);
+        const int d = tour.next(c);
+        twoOptMove(a, c);
+        setTabu(a, b);
+        setTabu(c, d);
+    }
+    else if (move.type == TwoOptMove)
+    {
+        const int b = tour.prev(a);
+        const int d = tour.prev(c);
+        twoOptMove(b, d);
+        setTabu(b, a);
+        setTabu(d, c);
+    }
+    else
+    {
+        const int b = tour.next(a);
+        const int p = tour.prev(c);
+        const int q = tour.next(c);
+        tour.moveSegment(c, c, a);
+        markChanged(a);
+        markChanged(b);
+        markChanged(c);
+        markChanged(p);
+        markChanged(q);
+        setTabu(a, b);
+        setTabu(p, c);
+        setTabu(c, q);
+    }
+    currentPathWeight += move.delta;
+}
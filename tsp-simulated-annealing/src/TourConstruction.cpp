@@ -0,0 +1,376 @@
+#include "TourConstruction.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+// Disjoint sets of vertices with path halving and union by size
+struct UnionFind
+{
+    std::vector<int> parent;
+    std::vector<int> size;
+
+    UnionFind(int count) : parent(count), size(count, 1)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            parent[i] = i;
+        }
+    }
+
+    int find(int v)
+    {
+        while (parent[v] != v)
+        {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+
+    // Returns false if u and v already are in the same set
+    bool unite(int u, int v)
+    {
+        u = find(u);
+        v = find(v);
+        if (u == v)
+        {
+            return false;
+        }
+        if (size[u] < size[v])
+        {
+            std::swap(u, v);
+        }
+        parent[v] = u;
+        size[u] += size[v];
+        return true;
+    }
+};
+
+struct CandidateEdge
+{
+    int weight;
+    int u;
+    int v;
+
+    bool operator<(const CandidateEdge &other) const
+    {
+        if (weight != other.weight)
+        {
+            return weight < other.weight;
+        }
+        return u != other.u ? u < other.u : v < other.v;
+    }
+};
+
+// Returns the edges from every vertex to its candidates, the shortest first
+static std::vector<CandidateEdge> getCandidateEdges(GraphMatrix *graph, NeighborLists &neighbors)
+{
+    const int vertexCount = graph->getVertexCount();
+    const int candidateCount = neighbors.getCount();
+
+    std::vector<CandidateEdge> edges;
+    edges.reserve(vertexCount * candidateCount);
+    for (int u = 0; u < vertexCount; ++u)
+    {
+        const int *candidates = neighbors.get(u);
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            CandidateEdge edge;
+            edge.weight = graph->getWeight(u, candidates[i]);
+            edge.u = u;
+            edge.v = candidates[i];
+            edges.push_back(edge);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+void TourConstruction::nearestNeighbor(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path)
+{
+    const int vertexCount = graph->getVertexCount();
+    const int candidateCount = neighbors.getCount();
+
+    // Unvisited vertices in an array with O(1) removal, for the fallback scan
+    std::vector<int> unvisited(vertexCount);
+    std::vector<int> unvisitedIndex(vertexCount);
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        unvisited[i] = i;
+        unvisitedIndex[i] = i;
+    }
+    int unvisitedCount = vertexCount;
+
+    int vertex = first;
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        if (i > 0)
+        {
+            const int last = path[i - 1];
+            const int *candidates = neighbors.get(last);
+            vertex = -1;
+            for (int j = 0; j < candidateCount; ++j)
+            {
+                if (unvisitedIndex[candidates[j]] >= 0)
+                {
+                    vertex = candidates[j];
+                    break;
+                }
+            }
+            if (vertex < 0)
+            {
+                int minWeight = INT_MAX;
+                for (int j = 0; j < unvisitedCount; ++j)
+                {
+                    const int weight = graph->getWeight(last, unvisited[j]);
+                    if (weight < minWeight)
+                    {
+                        minWeight = weight;
+                        vertex = unvisited[j];
+                    }
+                }
+            }
+        }
+
+        path[i] = vertex;
+        const int index = unvisitedIndex[vertex];
+        const int moved = unvisited[--unvisitedCount];
+        unvisited[index] = moved;
+        unvisitedIndex[moved] = index;
+        unvisitedIndex[vertex] = -1;
+    }
+}
+
+void TourConstruction::greedyEdge(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path)
+{
+    const int vertexCount = graph->getVertexCount();
+    const std::vector<CandidateEdge> edges = getCandidateEdges(graph, neighbors);
+
+    // Directed: link[2v] = successor, link[2v + 1] = predecessor; undirected: the (up to 2) neighbors
+    std::vector<int> link(2 * vertexCount, -1);
+    UnionFind fragments(vertexCount);
+    for (const CandidateEdge &edge : edges)
+    {
+        int *uLink = &link[2 * edge.u];
+        int *vLink = &link[2 * edge.v];
+        if (graph->directed)
+        {
+            if (uLink[0] < 0 && vLink[1] < 0 && fragments.unite(edge.u, edge.v))
+            {
+                uLink[0] = edge.v;
+                vLink[1] = edge.u;
+            }
+        }
+        else if (uLink[1] < 0 && vLink[1] < 0 && fragments.unite(edge.u, edge.v))
+        {
+            uLink[uLink[0] < 0 ? 0 : 1] = edge.v;
+            vLink[vLink[0] < 0 ? 0 : 1] = edge.u;
+        }
+    }
+
+    // Lay the fragments out one after another: fragment f is order[fragmentStart[f] .. fragmentStart[f + 1])
+    std::vector<int> order;
+    order.reserve(vertexCount);
+    std::vector<int> fragmentStart;
+    std::vector<int> fragmentOf(vertexCount, -1);
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        // Fragments are walked from an end: no predecessor / at most one neighbor
+        if (link[2 * v + 1] >= 0 || fragmentOf[v] >= 0)
+        {
+            continue;
+        }
+        fragmentStart.push_back(order.size());
+        for (int previous = -1, vertex = v; vertex >= 0;)
+        {
+            order.push_back(vertex);
+            fragmentOf[vertex] = fragmentStart.size() - 1;
+            int next;
+            if (graph->directed)
+            {
+                next = link[2 * vertex];
+            }
+            else
+            {
+                next = link[2 * vertex] != previous ? link[2 * vertex] : link[2 * vertex + 1];
+            }
+            previous = vertex;
+            vertex = next;
+        }
+    }
+    const int fragmentCount = fragmentStart.size();
+    fragmentStart.push_back(vertexCount);
+
+    // Join the fragments by nearest neighbor, an undirected fragment may be entered from either end
+    std::vector<char> used(fragmentCount, false);
+    int pathLength = 0;
+    int fragment = fragmentOf[first];
+    bool reversed = false;
+    for (int joined = 0; joined < fragmentCount; ++joined)
+    {
+        used[fragment] = true;
+        const int begin = fragmentStart[fragment];
+        const int end = fragmentStart[fragment + 1];
+        for (int i = begin; i < end; ++i)
+        {
+            path[pathLength++] = order[reversed ? begin + end - 1 - i : i];
+        }
+
+        const int tail = path[pathLength - 1];
+        int minWeight = INT_MAX;
+        for (int f = 0; f < fragmentCount; ++f)
+        {
+            if (used[f])
+            {
+                continue;
+            }
+            const int headWeight = graph->getWeight(tail, order[fragmentStart[f]]);
+            if (headWeight < minWeight)
+            {
+                minWeight = headWeight;
+                fragment = f;
+                reversed = false;
+            }
+            if (!graph->directed)
+            {
+                const int tailWeight = graph->getWeight(tail, order[fragmentStart[f + 1] - 1]);
+                if (tailWeight < minWeight)
+                {
+                    minWeight = tailWeight;
+                    fragment = f;
+                    reversed = true;
+                }
+            }
+        }
+    }
+}
+
+void TourConstruction::mstDoubling(GraphMatrix *graph, NeighborLists &neighbors, int first, int *path)
+{
+    const int vertexCount = graph->getVertexCount();
+    const std::vector<CandidateEdge> edges = getCandidateEdges(graph, neighbors);
+
+    // Kruskal over the candidate edges
+    std::vector<CandidateEdge> treeEdges;
+    treeEdges.reserve(vertexCount);
+    UnionFind components(vertexCount);
+    for (const CandidateEdge &edge : edges)
+    {
+        if (components.unite(edge.u, edge.v))
+        {
+            treeEdges.push_back(edge);
+        }
+    }
+    // The candidate graph may be disconnected, chain the remaining components
+    for (int v = 1; v < vertexCount; ++v)
+    {
+        if (components.unite(v - 1, v))
+        {
+            CandidateEdge edge;
+            edge.weight = graph->getWeight(v - 1, v);
+            edge.u = v - 1;
+            edge.v = v;
+            treeEdges.push_back(edge);
+        }
+    }
+
+    // Adjacency of the tree: the neighbors of v at [adjacencyStart[v], adjacencyStart[v + 1]),
+    // in the order of the edge weights, so that the walk visits the nearest subtree first
+    std::vector<int> adjacencyStart(vertexCount + 1, 0);
+    for (const CandidateEdge &edge : treeEdges)
+    {
+        ++adjacencyStart[edge.u + 1];
+        ++adjacencyStart[edge.v + 1];
+    }
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    }
+    std::vector<int> adjacency(adjacencyStart[vertexCount]);
+    std::vector<int> filled(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (const CandidateEdge &edge : treeEdges)
+    {
+        adjacency[filled[edge.u]++] = edge.v;
+        adjacency[filled[edge.v]++] = edge.u;
+    }
+
+    // Depth-first preorder walk
+    std::vector<char> visited(vertexCount, false);
+    std::vector<int> stack;
+    stack.push_back(first);
+    int pathLength = 0;
+    while (!stack.empty())
+    {
+        const int vertex = stack.back();
+        stack.pop_back();
+        if (visited[vertex])
+        {
+            continue;
+        }
+        visited[vertex] = true;
+        path[pathLength++] = vertex;
+
+        // Pushed backwards, so the first neighbor is visited first
+        for (int i = adjacencyStart[vertex + 1] - 1; i >= adjacencyStart[vertex]; --i)
+        {
+            if (!visited[adjacency[i]])
+            {
+                stack.push_back(adjacency[i]);
+            }
+        }
+    }
+}
+
+// Returns the distance of the point (x, y) along the Hilbert curve filling the side x side grid
+static uint64_t hilbertIndex(uint32_t side, uint32_t x, uint32_t y)
+{
+    uint64_t index = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2)
+    {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        index += (uint64_t)s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+bool TourConstruction::spaceFillingCurve(GraphMatrix *graph, int *path)
+{
+    if (!graph->hasCoordinates())
+    {
+        return false;
+    }
+
+    const int vertexCount = graph->getVertexCount();
+    const uint32_t side = 1 << 16;
+    const double minX = *std::min_element(graph->x.begin(), graph->x.end());
+    const double minY = *std::min_element(graph->y.begin(), graph->y.end());
+    const double extent = std::max(*std::max_element(graph->x.begin(), graph->x.end()) - minX,
+                                   *std::max_element(graph->y.begin(), graph->y.end()) - minY);
+    const double scale = extent > 0 ? (side - 1) / extent : 0;
+
+    std::vector<std::pair<uint64_t, int>> keys(vertexCount);
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        const uint32_t x = (graph->x[v] - minX) * scale;
+        const uint32_t y = (graph->y[v] - minY) * scale;
+        keys[v] = std::make_pair(hilbertIndex(side, x, y), v);
+    }
+    std::sort(keys.begin(), keys.end());
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        path[i] = keys[i].second;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+#include "Trace.hpp"
+
+// The buffer is written to the file once it grows past this size
+static const size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+Trace::~Trace()
+{
+    close();
+}
+
+bool Trace::open(std::string filePath, TraceParams params)
+{
+    close();
+
+    file = fopen(filePath.c_str(), "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    everyIters = params.everyIters;
+    everyMs = params.everyMs;
+    run = 0;
+
+    buffer.reserve(TRACE_BUFFER_SIZE + 256);
+    buffer = "run, iteration, elapsed time [ms], temperature, current weight, best weight\n";
+    return true;
+}
+
+void Trace::close()
+{
+    if (file == NULL)
+    {
+        return;
+    }
+    flushBuffer();
+    fclose(file);
+    file = NULL;
+}
+
+void Trace::flushBuffer()
+{
+    fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+}
+
+void Trace::startRun()
+{
+    ++run;
+    nextIteration = everyIters > 0 ? 0 : LLONG_MAX;
+    nextMs = everyMs > 0 ? 0 : ULONG_MAX;
+}
+
+void Trace::sample(long long iteration, unsigned long elapsedMs, double temperature, int currentWeight, int bestWeight)
+{
+    char line[128];
+    int length = snprintf(line, sizeof(line), "%i, %lli, %lu, %f, %i, %i\n",
+                          run, iteration, elapsedMs, temperature, currentWeight, bestWeight);
+    buffer.append(line, length);
+
+    if (everyIters > 0)
+    {
+        nextIteration = iteration + everyIters;
+    }
+    if (everyMs > 0)
+    {
+        nextMs = elapsedMs + everyMs;
+    }
+
+    if (buffer.size() >= TRACE_BUFFER_SIZE)
+    {
+        flushBuffer();
+    }
+}
@@ -0,0 +1,315 @@
+#include "TwoLevelListTour.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Segments are rebuilt once one of them grows past this multiple of the group size
+static const int MAX_SEGMENT_GROWTH = 4;
+
+TwoLevelListTour::TwoLevelListTour(int size, bool keepOrientation)
+{
+    this->size = size;
+    this->keepOrientation = keepOrientation;
+    groupSize = std::max(8, (int)std::sqrt((double)size));
+    segmentOf.resize(size);
+    indexOf.resize(size);
+    segments.resize(std::max(1, (size + groupSize - 1) / groupSize));
+}
+
+void TwoLevelListTour::set(const int *path)
+{
+    reversed = false;
+    const int segmentCount = segments.size();
+    for (int s = 0; s < segmentCount; ++s)
+    {
+        const int first = s * groupSize;
+        const int count = std::min(size, first + groupSize) - first;
+
+        Segment &segment = segments[s];
+        segment.next = s + 1 == segmentCount ? 0 : s + 1;
+        segment.prev = s == 0 ? segmentCount - 1 : s - 1;
+        segment.rank = s;
+        assignSegment(s, path + first, count);
+    }
+    unbalanced = false;
+}
+
+void TwoLevelListTour::copyTo(int *path)
+{
+    int vertex = segments[0].vertices[0];
+    for (int i = 0; i < size; ++i)
+    {
+        path[i] = vertex;
+        vertex = next(vertex);
+    }
+}
+
+void TwoLevelListTour::assignSegment(int segmentIndex, const int *vertices, int count)
+{
+    Segment &segment = segments[segmentIndex];
+    segment.vertices.assign(vertices, vertices + count);
+    segment.reversed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        segmentOf[vertices[i]] = segmentIndex;
+        indexOf[vertices[i]] = i;
+    }
+    if (count > MAX_SEGMENT_GROWTH * groupSize)
+    {
+        unbalanced = true;
+    }
+}
+
+void TwoLevelListTour::appendSegment(int segmentIndex, std::vector<int> &out)
+{
+    const Segment &segment = segments[segmentIndex];
+    if (segment.reversed)
+    {
+        out.insert(out.end(), segment.vertices.rbegin(), segment.vertices.rend());
+    }
+    else
+    {
+        out.insert(out.end(), segment.vertices.begin(), segment.vertices.end());
+    }
+}
+
+void TwoLevelListTour::rebuild()
+{
+    const bool wasReversed = reversed;
+
+    buffer.clear();
+    int s = 0;
+    do
+    {
+        appendSegment(s, buffer);
+        s = segments[s].next;
+    } while (s != 0);
+
+    set(buffer.data());
+    reversed = wasReversed;
+}
+
+bool TwoLevelListTour::rawBetween(int a, int b, int c)
+{
+    // Position keys increase along the raw order, starting from the segment of rank 0
+    const long keyA = (long)segments[segmentOf[a]].rank * (size + 1) + tourIndex(a);
+    const long keyB = (long)segments[segmentOf[b]].rank * (size + 1) + tourIndex(b);
+    const long keyC = (long)segments[segmentOf[c]].rank * (size + 1) + tourIndex(c);
+
+    if (keyA <= keyC)
+    {
+        return keyA <= keyB && keyB <= keyC;
+    }
+    return keyB >= keyA || keyB <= keyC;
+}
+
+int TwoLevelListTour::rawLength(int first, int last)
+{
+    const int firstSegment = segmentOf[first];
+    const int lastSegment = segmentOf[last];
+    if (firstSegment == lastSegment && tourIndex(first) <= tourIndex(last))
+    {
+        return tourIndex(last) - tourIndex(first) + 1;
+    }
+
+    int length = segments[firstSegment].vertices.size() - tourIndex(first) + tourIndex(last) + 1;
+    for (int s = segments[firstSegment].next; s != lastSegment; s = segments[s].next)
+    {
+        length += segments[s].vertices.size();
+    }
+    return length;
+}
+
+void TwoLevelListTour::twoOptMove(int a, int c)
+{
+    if (reversed)
+    {
+        rawReverse(c, rawPrev(a));
+    }
+    else
+    {
+        rawReverse(rawNext(a), c);
+    }
+
+    if (unbalanced)
+    {
+        rebuild();
+    }
+}
+
+void TwoLevelListTour::rawReverse(int first, int last)
+{
+    if (first == last)
+    {
+        return;
+    }
+    // Reversing the whole tour only changes its orientation
+    if (rawNext(last) == first)
+    {
+        reversed = reversed != keepOrientation;
+        return;
+    }
+
+    const bool inSegment = segmentOf[first] == segmentOf[last];
+    if (!inSegment || tourIndex(first) > tourIndex(last))
+    {
+        // A part wrapping around inside one segment or longer than half of the tour:
+        // reversing the rest gives the same cycle traversed in the other direction
+        if (inSegment || 2 * rawLength(first, last) > size)
+        {
+            const int restFirst = rawNext(last);
+            last = rawPrev(first);
+            first = restFirst;
+            reversed = reversed != keepOrientation;
+        }
+    }
+
+    if (segmentOf[first] == segmentOf[last] && tourIndex(first) <= tourIndex(last))
+    {
+        reverseInSegment(first, last);
+        return;
+    }
+
+    // Make `first` the head of a segment and `last` the tail of a segment
+    split(first, -1);
+    if (segmentOf[first] == segmentOf[last] && tourIndex(first) <= tourIndex(last))
+    {
+        reverseInSegment(first, last);
+        return;
+    }
+    split(rawNext(last), segmentOf[first]);
+
+    // Reverse the order of the segments from the one of `first` to the one of `last`
+    const int firstSegment = segmentOf[first];
+    const int lastSegment = segmentOf[last];
+    const int before = segments[firstSegment].prev;
+    const int after = segments[lastSegment].next;
+    const int firstRank = segments[firstSegment].rank;
+    const int segmentCount = segments.size();
+
+    partBuffer.clear();
+    for (int s = firstSegment;; s = segments[s].next)
+    {
+        partBuffer.push_back(s);
+        if (s == lastSegment)
+        {
+            break;
+        }
+    }
+
+    const int count = partBuffer.size();
+    for (int i = 0; i < count; ++i)
+    {
+        Segment &segment = segments[partBuffer[count - 1 - i]];
+        segment.reversed = !segment.reversed;
+        segment.rank = (firstRank + i) % segmentCount;
+        segment.prev = i == 0 ? before : partBuffer[count - i];
+        segment.next = i == count - 1 ? after : partBuffer[count - 2 - i];
+    }
+    segments[before].next = partBuffer[count - 1];
+    segments[after].prev = partBuffer[0];
+}
+
+void TwoLevelListTour::reverseInSegment(int first, int last)
+{
+    Segment &segment = segments[segmentOf[first]];
+    const int low = std::min(indexOf[first], indexOf[last]);
+    const int high = std::max(indexOf[first], indexOf[last]);
+
+    std::reverse(segment.vertices.begin() + low, segment.vertices.begin() + high + 1);
+    for (int i = low; i <= high; ++i)
+    {
+        indexOf[segment.vertices[i]] = i;
+    }
+}
+
+void TwoLevelListTour::split(int vertex, int keep)
+{
+    const int index = tourIndex(vertex);
+    if (index == 0)
+    {
+        return;
+    }
+
+    const int s = segmentOf[vertex];
+    const int count = segments[s].vertices.size();
+    const int prevSegment = segments[s].prev;
+    const int nextSegment = segments[s].next;
+
+    partBuffer.clear();
+    appendSegment(s, partBuffer);
+
+    // Move the smaller part: the one before `vertex` to the end of the previous segment,
+    // or the one starting at `vertex` to the beginning of the next segment
+    const bool moveFront = 2 * index <= count || nextSegment == keep;
+    buffer.clear();
+    if (moveFront)
+    {
+        appendSegment(prevSegment, buffer);
+        buffer.insert(buffer.end(), partBuffer.begin(), partBuffer.begin() + index);
+        assignSegment(prevSegment, buffer.data(), buffer.size());
+        assignSegment(s, partBuffer.data() + index, count - index);
+    }
+    else
+    {
+        buffer.insert(buffer.end(), partBuffer.begin() + index, partBuffer.end());
+        appendSegment(nextSegment, buffer);
+        assignSegment(nextSegment, buffer.data(), buffer.size());
+        assignSegment(s, partBuffer.data(), index);
+    }
+}
+
+void TwoLevelListTour::moveSegment(int first, int last, int after)
+{
+    // ... -> a -> [first .. last] -> b -> ... -> after -> q -> ...
+    //   => ... -> a -> b -> ... -> after -> [first .. last] -> q -> ...
+    buffer.clear();
+    const int b = next(last);
+    for (int vertex = b;; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == after)
+        {
+            break;
+        }
+    }
+    for (int vertex = first;; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == last)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(after); vertex != first; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+    }
+    set(buffer.data());
+}
+
+void TwoLevelListTour::doubleBridge(int a, int b, int c)
+{
+    // a -> [X] -> [Y] -> d  =>  a -> [Y] -> [X] -> d
+    buffer.clear();
+    for (int vertex = next(b);; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == c)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(a);; vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+        if (vertex == b)
+        {
+            break;
+        }
+    }
+    for (int vertex = next(c); vertex != next(a); vertex = next(vertex))
+    {
+        buffer.push_back(vertex);
+    }
+    set(buffer.data());
+}
@@ -0,0 +1,196 @@
+#include "TwoOpt.hpp"
+
+template <class Tour>
+TwoOpt<Tour>::TwoOpt(GraphMatrix *graph, AlgorithmParams params)
+    : TSPAlgorithm(graph),
+      neighbors(graph, params.localSearch.neighborCount),
+      tour(graph->getVertexCount(), graph->directed)
+{
+    this->maxNoImprovementIters = INT_MAX;
+    this->maxExecutionTime = params.maxExecutionTimeMs;
+    this->initialPathMode = params.initialPathMode;
+    this->constructionNeighbors = &neighbors;
+
+    queue.resize(graphSize);
+    queued.resize(graphSize);
+}
+
+template <class Tour>
+Path TwoOpt<Tour>::solveTSP()
+{
+    setInitialPath();
+    currentPathWeight = getCurrentPathWeight();
+    initialPathWeight = currentPathWeight;
+    printImprovement(0, currentPathWeight);
+
+    optimize();
+
+    printImprovement(moveCount, currentPathWeight);
+    printf("2-opt moves: %li, time: %lu ms\n", moveCount, timer.getElapsedMs());
+    printPath(bestFoundPath);
+    return getResultPath();
+}
+
+template <class Tour>
+Path TwoOpt<Tour>::improvePath(const Path &path)
+{
+    for (int i = 0; i < graphSize; ++i)
+    {
+        currentPath[i] = path.vertices[i];
+    }
+    currentPathWeight = path.weight;
+
+    optimize();
+
+    if (currentPathWeight < path.weight)
+    {
+        printf("2-opt polishing: %i -> %i (%.2f%%), %li moves\n", path.weight, currentPathWeight, getPrd(currentPathWeight), moveCount);
+    }
+    return getResultPath();
+}
+
+template <class Tour>
+void TwoOpt<Tour>::optimize()
+{
+    startTimer();
+    moveCount = 0;
+    tour.set(currentPath);
+
+    queueHead = 0;
+    queueCount = 0;
+    for (int i = 0; i < graphSize; ++i)
+    {
+        queued[i] = false;
+    }
+    for (int i = 0; i < graphSize; ++i)
+    {
+        activate(currentPath[i]);
+    }
+
+    while (queueCount > 0)
+    {
+        const int vertex = queue[queueHead];
+        queueHead = queueHead + 1 == graphSize ? 0 : queueHead + 1;
+        --queueCount;
+        queued[vertex] = false;
+
+        while (improveVertex(vertex))
+        {
+            ++moveCount;
+        }
+
+        if (--itersUntilTimeCheck <= 0 && executionTimeLimit())
+        {
+            printf("The execution time limit has been reached\n");
+            break;
+        }
+    }
+
+    tour.copyTo(currentPath);
+    copyPath(currentPath, bestFoundPath);
+    bestFoundPathWeight = currentPathWeight;
+}
+
+template <class Tour>
+void TwoOpt<Tour>::activate(int vertex)
+{
+    if (queued[vertex])
+    {
+        return;
+    }
+    queued[vertex] = true;
+    int tail = queueHead + queueCount;
+    queue[tail >= graphSize ? tail - graphSize : tail] = vertex;
+    ++queueCount;
+}
+
+template <class Tour>
+bool TwoOpt<Tour>::improveVertex(int a)
+{
+    const int *candidates = neighbors.get(a);
+    const int candidateCount = neighbors.getCount();
+    const int directions = graph->directed ? 1 : 2;
+
+    for (int direction = 0; direction < directions; ++direction)
+    {
+        // Successor: ... a -> b ... c -> d ...  =>  ... a -> c ... b -> d ...
+        // Predecessor: ... b -> a ... d -> c ...  =>  ... b -> d ... a -> c ...
+        const bool successor = direction == 0;
+        const int b = successor ? tour.next(a) : tour.prev(a);
+        const int ab = successor ? graph->getWeight(a, b) : graph->getWeight(b, a);
+
+        for (int i = 0; i < candidateCount; ++i)
+        {
+            const int c = candidates[i];
+            const int ac = graph->getWeight(a, c);
+            // The new edge must be shorter than the removed one for the move to improve
+            if (ac >= ab)
+            {
+                break;
+            }
+
+            const int d = successor ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a)
+            {
+                continue;
+            }
+
+            int delta;
+            if (successor)
+            {
+                delta = ac + graph->getWeight(b, d) - ab - graph->getWeight(c, d);
+                if (graph->directed)
+                {
+                    delta += reversalDelta(b, c);
+                }
+            }
+            else
+            {
+                delta = ac + graph->getWeight(b, d) - ab - graph->getWeight(d, c);
+            }
+
+            if (delta < 0)
+            {
+                if (successor)
+                {
+                    tour.twoOptMove(a, c);
+                }
+                else
+                {
+                    tour.twoOptMove(b, d);
+                }
+                currentPathWeight += delta;
+
+                activate(a);
+                activate(b);
+                activate(c);
+                activate(d);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <class Tour>
+int TwoOpt<Tour>::reversalDelta(int first, int last)
+{
+    int delta = 0;
+    for (int vertex = first; vertex != last;)
+    {
+        const int next = tour.next(vertex);
+        delta += graph->getWeight(next, vertex) - graph->getWeight(vertex, next);
+        vertex = next;
+    }
+    return delta;
+}
+
+template <class Tour>
+Path TwoOpt<Tour>::getResultPath()
+{
+    std::vector<int> resPath(bestFoundPath, bestFoundPath + graphSize);
+    return Path(resPath, bestFoundPathWeight, getPrd(bestFoundPathWeight));
+}
+
+template class TwoOpt<ArrayTour>;
+template class TwoOpt<TwoLevelListTour>;
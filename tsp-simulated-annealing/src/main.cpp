@@ -1,18 +1,30 @@
 #include "main.hpp"
 
 #include <iostream>
+#include <sstream>
 #include "graphGenerator.hpp"
 #include "FileUtils.hpp"
+#include "InstanceCache.hpp"
 #include "Timer.hpp"
 #include "tests.hpp"
 #include "GraphMatrix.hpp"
 #include "printColor.hpp"
 #include "TSPAlgorithm.hpp"
 
-int main(void)
+int main(int argc, char **argv)
 {
     srand(1);
 
+    if (argc == 3 && std::string(argv[1]) == "--resume")
+    {
+        return Tests::resumeInstanceTest(argv[2]) ? 0 : 1;
+    }
+    if (argc > 1)
+    {
+        printf("Usage: %s [--resume <checkpoint file>]\n", argv[0]);
+        return 1;
+    }
+
     ini.SetUnicode();
 
     SI_Error rc = ini.LoadFile("settings.ini");
@@ -25,15 +37,32 @@ int main(void)
     const std::string mode = ini.GetValue("common", "mode", "UNKNOWN");
     const std::string inputDir = ini.GetValue("common", "input_dir", "./instances");
     const std::string outputDir = ini.GetValue("common", "output_dir", "./results");
+    const std::string cacheDir = ini.GetValue("common", "cache_dir", "");
 
     if (mode == "file_instance_test")
     {
-        fileInstanceTest(inputDir, outputDir);
+        fileInstanceTest(inputDir, outputDir, cacheDir, false);
+    }
+    else if (mode == "multi_start_test")
+    {
+        fileInstanceTest(inputDir, outputDir, cacheDir, true);
     }
     else if (mode == "random_instance_test")
     {
         randomInstanceTest(outputDir);
     }
+    else if (mode == "tour_benchmark")
+    {
+        tourBenchmark(outputDir);
+    }
+    else if (mode == "loader_benchmark")
+    {
+        loaderBenchmark(inputDir, outputDir, cacheDir);
+    }
+    else if (mode == "context_benchmark")
+    {
+        contextBenchmark(outputDir);
+    }
     else
     {
         printf("Wrong mode value.\n");
@@ -43,9 +72,10 @@ int main(void)
     return 0;
 }
 
-void fileInstanceTest(std::string inputDir, std::string outputDir)
+void fileInstanceTest(std::string inputDir, std::string outputDir, std::string cacheDir, bool multiStart)
 {
     const int instanceCount = atoi(ini.GetValue("file_instance_test", "number_of_instances", "1"));
+    const int threadCount = atoi(ini.GetValue("multi_start_test", "threads", "0"));
     const auto params = getAlorithmParams();
 
     for (int i = 0; i < instanceCount; i++)
@@ -65,16 +95,24 @@ void fileInstanceTest(std::string inputDir, std::string outputDir)
         printf("Iteration count: %i\n\n", iterCount);
 
         // Wczytanie grafu
-        GraphMatrix *graph = FileUtils::loadGraph(inputFilePath);
+        std::string error;
+        GraphMatrix *graph = InstanceCache::load(inputFilePath, cacheDir, &error);
         if (graph == NULL)
         {
-            printf("File not found.\n");
+            printf("%s\n", error.c_str());
             continue;
         }
         printf("Graph read from file:\n");
         graph->display();
 
-        Tests::fileInstanceTest(graph, iterCount, instanceName, outputFilePath, params);
+        if (multiStart)
+        {
+            Tests::multiStartTest(graph, iterCount, threadCount, instanceName, outputFilePath, params);
+        }
+        else
+        {
+            Tests::fileInstanceTest(graph, iterCount, inputFilePath, instanceName, outputFilePath, params);
+        }
 
         printf("Finished.\n");
         printf("Results saved to file.\n");
@@ -99,6 +137,56 @@ void randomInstanceTest(std::string outputDir)
     Tests::randomInstanceTest(minSize, maxSize, iterCountPerInstance, instanceCountPerSize, outputFilePath, params);
 }
 
+void tourBenchmark(std::string outputDir)
+{
+    printf("Tour benchmark\n\n");
+    const char *tag = "tour_benchmark";
+
+    std::vector<int> sizes;
+    std::stringstream sizesStream(ini.GetValue(tag, "sizes", "1000,10000,100000"));
+    std::string size;
+    while (std::getline(sizesStream, size, ','))
+    {
+        sizes.push_back(atoi(size.c_str()));
+    }
+    const int moveCount = atoi(ini.GetValue(tag, "moves", "100000"));
+    const std::string outputFile = ini.GetValue(tag, "output", "tour_benchmark.csv");
+
+    Tests::tourBenchmark(sizes, moveCount, outputDir + "/" + outputFile);
+}
+
+void loaderBenchmark(std::string inputDir, std::string outputDir, std::string cacheDir)
+{
+    printf("Loader benchmark\n\n");
+    const char *tag = "loader_benchmark";
+
+    const int repetitions = atoi(ini.GetValue(tag, "repetitions", "10"));
+    const std::string outputFile = ini.GetValue(tag, "output", "loader_benchmark.csv");
+
+    // The cache files are timed as well, in the directory of the results if the cache is disabled
+    Tests::loaderBenchmark(inputDir, cacheDir.empty() ? outputDir + "/instance_cache" : cacheDir, repetitions,
+                           outputDir + "/" + outputFile);
+}
+
+void contextBenchmark(std::string outputDir)
+{
+    printf("Solve context benchmark\n\n");
+    const char *tag = "context_benchmark";
+    const auto params = getAlorithmParams();
+
+    std::vector<int> sizes;
+    std::stringstream sizesStream(ini.GetValue(tag, "sizes", "20,100,1000,2000"));
+    std::string size;
+    while (std::getline(sizesStream, size, ','))
+    {
+        sizes.push_back(atoi(size.c_str()));
+    }
+    const int repetitions = atoi(ini.GetValue(tag, "repetitions", "100000"));
+    const std::string outputFile = ini.GetValue(tag, "output", "context_benchmark.csv");
+
+    Tests::contextBenchmark(sizes, repetitions, outputDir + "/" + outputFile, params);
+}
+
 AlgorithmParams getAlorithmParams()
 {
     const char *tag = "algorithm_params";
@@ -112,8 +200,33 @@ AlgorithmParams getAlorithmParams()
     float coolingRate = std::stof(ini.GetValue(tag, "cooling_rate", "0.999"));
     float temperatureCoefficient = std::stof(ini.GetValue(tag, "temp_coeff", "100.0"));
 
-    initialPathMode = initialPathModeStr == "greedy" ? Greedy : InOrder;
-    neighborMode = neighborModeStr == "swap" ? Swap : Invert;
+    if (initialPathModeStr == "greedy")
+        initialPathMode = Greedy;
+    else if (initialPathModeStr == "nearest_neighbor")
+        initialPathMode = NearestNeighbor;
+    else if (initialPathModeStr == "greedy_edge")
+        initialPathMode = GreedyEdge;
+    else if (initialPathModeStr == "mst")
+        initialPathMode = MstDoubling;
+    else if (initialPathModeStr == "space_filling_curve")
+        initialPathMode = SpaceFillingCurve;
+    else
+        initialPathMode = InOrder;
+    if (neighborModeStr == "swap")
+        neighborMode = Swap;
+    else if (neighborModeStr == "invert")
+        neighborMode = Invert;
+    else if (neighborModeStr == "or_opt")
+        neighborMode = OrOpt;
+    else if (neighborModeStr == "or2opt")
+        neighborMode = Or2Opt;
+    else if (neighborModeStr == "mixed")
+        neighborMode = Mixed;
+    else
+    {
+        printf("Wrong neighbor_mode value: %s\n", neighborModeStr.c_str());
+        exit(1);
+    }
 
     auto params = AlgorithmParams(
         maxExecTimeMs,
@@ -122,6 +235,74 @@ AlgorithmParams getAlorithmParams()
         coolingRate,
         temperatureCoefficient);
 
+    params.moveProbabilities.swap = std::stod(ini.GetValue(tag, "move_prob_swap", "0.0"));
+    params.moveProbabilities.invert = std::stod(ini.GetValue(tag, "move_prob_invert", "0.5"));
+    params.moveProbabilities.orOpt = std::stod(ini.GetValue(tag, "move_prob_or_opt", "0.5"));
+    params.moveProbabilities.or2Opt = std::stod(ini.GetValue(tag, "move_prob_or2opt", "0.0"));
+
+    std::string scheduleStr = ini.GetValue(tag, "cooling_schedule", "geometric");
+    if (scheduleStr == "lundy_mees")
+        params.cooling.schedule = LundyMeesCooling;
+    else if (scheduleStr == "markov_chain")
+        params.cooling.schedule = MarkovChainCooling;
+    else if (scheduleStr == "adaptive")
+        params.cooling.schedule = AdaptiveCooling;
+    else
+        params.cooling.schedule = GeometricCooling;
+
+    std::string initialTempModeStr = ini.GetValue(tag, "initial_temp_mode", "sampled");
+    params.cooling.initialTemperatureMode = initialTempModeStr == "aad" ? AadTemperature : SampledTemperature;
+    params.cooling.initialAcceptance = std::stod(ini.GetValue(tag, "initial_acceptance", "0.5"));
+    params.cooling.lundyMeesCoefficient = std::stod(ini.GetValue(tag, "lundy_mees_coeff", "1e-4"));
+    params.cooling.chainLengthFactor = atoi(ini.GetValue(tag, "chain_length_factor", "10"));
+    params.cooling.chainCoolingRate = std::stod(ini.GetValue(tag, "chain_cooling_rate", "0.95"));
+    params.cooling.initialTargetAcceptance = std::stod(ini.GetValue(tag, "initial_target_acceptance", "0.3"));
+    params.cooling.finalTargetAcceptance = std::stod(ini.GetValue(tag, "final_target_acceptance", "0.001"));
+    params.cooling.reheatAfterFactor = atoi(ini.GetValue(tag, "reheat_after_factor", "0"));
+    params.cooling.reheatRatio = std::stod(ini.GetValue(tag, "reheat_ratio", "0.1"));
+
+    params.moveBatch.size = atoi(ini.GetValue(tag, "batch_size", "0"));
+    params.moveBatch.bestOfBatchRatio = std::stod(ini.GetValue(tag, "best_of_batch_ratio", "0"));
+
+    std::string solverStr = ini.GetValue(tag, "solver", "simulated_annealing");
+    if (solverStr == "parallel_tempering")
+        params.solver = ParallelTemperingSolver;
+    else if (solverStr == "two_opt")
+        params.solver = TwoOptSolver;
+    else if (solverStr == "lin_kernighan")
+        params.solver = LinKernighanSolver;
+    else if (solverStr == "tabu_search")
+        params.solver = TabuSearchSolver;
+    else
+        params.solver = SimulatedAnnealingSolver;
+
+    const char *lsTag = "local_search";
+    params.localSearch.neighborCount = atoi(ini.GetValue(lsTag, "neighbor_count", "10"));
+    params.localSearch.polish = ini.GetBoolValue(lsTag, "polish", false);
+    params.localSearch.lkMaxDepth = atoi(ini.GetValue(lsTag, "lk_max_depth", "50"));
+    params.localSearch.lkBreadth = atoi(ini.GetValue(lsTag, "lk_breadth", "5"));
+    std::string tourStr = ini.GetValue(lsTag, "tour", "array");
+    params.localSearch.tour = tourStr == "two_level_list" ? TwoLevelListTourType : ArrayTourType;
+
+    const char *tsTag = "tabu_search";
+    params.tabuSearch.tenure = atoi(ini.GetValue(tsTag, "tenure", "0"));
+    params.tabuSearch.threads = atoi(ini.GetValue(tsTag, "threads", "0"));
+    params.tabuSearch.parallelMinVertices = atoi(ini.GetValue(tsTag, "parallel_min_vertices", "2000"));
+
+    const char *ptTag = "parallel_tempering";
+    params.parallelTempering.replicas = atoi(ini.GetValue(ptTag, "replicas", "0"));
+    params.parallelTempering.temperatureRatio = std::stod(ini.GetValue(ptTag, "temp_ratio", "1e-6"));
+    params.parallelTempering.exchangeInterval = atoi(ini.GetValue(ptTag, "exchange_interval", "10000"));
+
+    const char *traceTag = "trace";
+    params.trace.enabled = ini.GetBoolValue(traceTag, "enabled", false);
+    params.trace.everyIters = atoi(ini.GetValue(traceTag, "every_iters", "0"));
+    params.trace.everyMs = atoi(ini.GetValue(traceTag, "every_ms", "0"));
+
+    const char *checkpointTag = "checkpoint";
+    params.checkpoint.enabled = ini.GetBoolValue(checkpointTag, "enabled", false);
+    params.checkpoint.everyMs = atoi(ini.GetValue(checkpointTag, "every_ms", "10000"));
+
     params.print();
     return params;
 }
@@ -4,26 +4,285 @@
 #include "Timer.hpp"
 #include "graphGenerator.hpp"
 #include "FileUtils.hpp"
+#include "InstanceCache.hpp"
 #include "printColor.hpp"
 #include "TestResult.hpp"
 #include "Path.hpp"
 #include "SimulatedAnnealing.hpp"
+#include "ParallelTempering.hpp"
+#include "TwoOpt.hpp"
+#include "LinKernighan.hpp"
+#include "TabuSearch.hpp"
+#include "Trace.hpp"
+#include "Checkpoint.hpp"
+#include "SharedBest.hpp"
+#include "ThreadPool.hpp"
+#include "Random.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
 
-void Tests::fileInstanceTest(GraphMatrix *graph, int iterCount, std::string instanceName, std::string outputPath, AlgorithmParams params)
+// Returns the path of the file with `suffix` which accompanies the results file `outputPath`
+static std::string getCompanionPath(std::string outputPath, std::string suffix)
 {
-    FileUtils::writeInstanceTestHeader(outputPath);
-    Timer timer;
+    const std::string extension = ".csv";
+    if (outputPath.size() >= extension.size() &&
+        outputPath.compare(outputPath.size() - extension.size(), extension.size(), extension) == 0)
+    {
+        outputPath.erase(outputPath.size() - extension.size());
+    }
+    return outputPath + suffix;
+}
+
+// Opens the trace for the results file `outputPath` if tracing is enabled
+static Trace *openTrace(Trace *trace, std::string outputPath, AlgorithmParams params)
+{
+    if (!params.trace.enabled)
+    {
+        return NULL;
+    }
+    if (!trace->open(getCompanionPath(outputPath, ".trace.csv"), params.trace))
+    {
+        printf("Could not open the trace file\n");
+        return NULL;
+    }
+    return trace;
+}
+
+// Runs the local search solver selected in `params` on the tour representation `Tour`
+template <class Tour>
+static Path solveLocalSearch(GraphMatrix *graph, AlgorithmParams params)
+{
+    if (params.solver == TwoOptSolver)
+    {
+        TwoOpt<Tour> alg(graph, params);
+        return alg.solveTSP();
+    }
+    LinKernighan<Tour> alg(graph, params);
+    return alg.solveTSP();
+}
+
+// Improves `path` with 2-opt on the tour representation `Tour`
+template <class Tour>
+static Path polishPath(GraphMatrix *graph, AlgorithmParams params, const Path &path)
+{
+    TwoOpt<Tour> polish(graph, params);
+    return polish.improvePath(path);
+}
+
+// Solves the TSP on `graph` using the solver selected in `params`. The simulated annealing works in
+// `context` (if not NULL), saves its state to `checkpoint` (if not NULL) and continues the run of `resumeState` (if not NULL).
+static Path solve(GraphMatrix *graph, AlgorithmParams params, Trace *trace, SolveContext *context = NULL,
+                  Checkpoint *checkpoint = NULL, const SolverState *resumeState = NULL)
+{
+    if (params.solver == TwoOptSolver || params.solver == LinKernighanSolver)
+    {
+        if (params.localSearch.tour == TwoLevelListTourType)
+        {
+            return solveLocalSearch<TwoLevelListTour>(graph, params);
+        }
+        return solveLocalSearch<ArrayTour>(graph, params);
+    }
+
+    if (params.solver == TabuSearchSolver)
+    {
+        TabuSearch alg(graph, params);
+        return alg.solveTSP();
+    }
+
+    Path path;
+    if (params.solver == ParallelTemperingSolver)
+    {
+        ParallelTempering alg(graph, params);
+        alg.setTrace(trace);
+        path = alg.solveTSP();
+    }
+    else
+    {
+        SimulatedAnnealing alg(graph, params, context);
+        alg.setTrace(trace);
+        alg.setCheckpoint(checkpoint);
+        if (resumeState != NULL)
+        {
+            alg.resume(*resumeState);
+        }
+        path = alg.solveTSP();
+    }
 
-    for (int i = 0; i < iterCount; ++i)
+    if (params.localSearch.polish)
     {
+        if (params.localSearch.tour == TwoLevelListTourType)
+        {
+            path = polishPath<TwoLevelListTour>(graph, params, path);
+        }
+        else
+        {
+            path = polishPath<ArrayTour>(graph, params, path);
+        }
+    }
+    return path;
+}
+
+// Runs the runs run.run .. run.runCount - 1 of the instance test, the first one continued from
+// `resumeState` if not NULL, and appends their results to the results file
+static void runInstanceTest(GraphMatrix *graph, CheckpointRun run, Trace *trace, const SolverState *resumeState)
+{
+    const AlgorithmParams &params = run.params;
+    Checkpoint checkpointFile;
+    Checkpoint *checkpoint = NULL;
+    if (params.checkpoint.enabled)
+    {
+        if (params.solver == SimulatedAnnealingSolver)
+        {
+            checkpointFile.open(getCompanionPath(run.outputPath, ".checkpoint"), params.checkpoint.everyMs);
+            checkpoint = &checkpointFile;
+        }
+        else
+        {
+            printf("Checkpoints are saved by the simulated annealing solver only\n");
+        }
+    }
+
+    SolveContext context;
+    Timer timer;
+    for (; run.run < run.runCount; ++run.run)
+    {
+        if (checkpoint != NULL)
+        {
+            checkpoint->startRun(run);
+        }
         timer.start();
-        SimulatedAnnealing alg(graph, params);
-        Path path = alg.solveTSP();
-        const unsigned long elapsedTime = timer.getElapsedNs();
+        Path path = solve(graph, params, trace, &context, checkpoint, resumeState);
+        unsigned long elapsedTime = timer.getElapsedNs();
+        if (resumeState != NULL)
+        {
+            elapsedTime += resumeState->elapsedMs * 1000000;
+            resumeState = NULL;
+        }
 
-        TestResult testResult(instanceName, graph->getVertexCount(), elapsedTime, path, path.prd);
+        TestResult testResult(run.instanceName, graph->getVertexCount(), elapsedTime, path, path.prd);
 
-        FileUtils::appendTestResult(outputPath, testResult);
+        FileUtils::appendTestResult(run.outputPath, testResult);
+        if (checkpoint != NULL)
+        {
+            // The result is saved, the run must not be resumed any more
+            checkpoint->remove();
+        }
+    }
+}
+
+void Tests::fileInstanceTest(GraphMatrix *graph, int iterCount, std::string instancePath, std::string instanceName, std::string outputPath, AlgorithmParams params)
+{
+    FileUtils::writeInstanceTestHeader(outputPath);
+    Trace traceFile;
+    Trace *trace = openTrace(&traceFile, outputPath, params);
+
+    CheckpointRun run;
+    run.instancePath = instancePath;
+    run.instanceName = instanceName;
+    run.outputPath = outputPath;
+    run.run = 0;
+    run.runCount = iterCount;
+    run.params = params;
+    runInstanceTest(graph, run, trace, NULL);
+}
+
+bool Tests::resumeInstanceTest(std::string checkpointPath)
+{
+    SolverState state;
+    if (!Checkpoint::read(checkpointPath, state))
+    {
+        printf("Could not read the checkpoint file %s\n", checkpointPath.c_str());
+        return false;
+    }
+
+    std::string error;
+    GraphMatrix *graph = FileUtils::loadGraph(state.run.instancePath, &error);
+    if (graph == NULL)
+    {
+        printf("%s\n", error.c_str());
+        return false;
+    }
+    const size_t vertexCount = graph->getVertexCount();
+    if (state.currentPath.size() != vertexCount || state.bestFoundPath.size() != vertexCount)
+    {
+        printf("The checkpoint does not match the instance %s\n", state.run.instancePath.c_str());
+        delete graph;
+        return false;
+    }
+
+    state.run.params.print();
+    printf("\nResuming run %i / %i of %s after %lu ms\n", state.run.run + 1, state.run.runCount,
+           state.run.instancePath.c_str(), (unsigned long)state.elapsedMs);
+    printf("Output: %s\n\n", state.run.outputPath.c_str());
+
+    // The trace of the interrupted runs is kept, the resumed runs are not traced
+    runInstanceTest(graph, state.run, NULL, &state);
+    delete graph;
+    return true;
+}
+
+void Tests::multiStartTest(GraphMatrix *graph, int runCount, int threadCount, std::string instanceName, std::string outputPath, AlgorithmParams params)
+{
+    FileUtils::writeInstanceTestHeader(outputPath);
+
+    SharedBest best;
+    if (graph->isOptimumKnown())
+    {
+        best.setTarget(graph->getOptimum());
+    }
+
+    // Results of the runs, in order of the runs (runs skipped after the optimum was reached stay empty)
+    std::vector<TestResult *> results(runCount, NULL);
+    const uint64_t baseSeed = rand();
+
+    {
+        ThreadPool pool(threadCount);
+        printf("Multi-start: %i runs on %i threads\n", runCount, pool.getThreadCount());
+
+        for (int i = 0; i < runCount; ++i)
+        {
+            pool.submit([&, i]()
+                        {
+                if (best.isTargetReached())
+                {
+                    return;
+                }
+                // The runs of a worker thread share its working memory
+                static thread_local SolveContext context;
+                Timer timer;
+                timer.start();
+                SimulatedAnnealing alg(graph, params, &context);
+                alg.setSeed(baseSeed + i);
+                alg.setSharedBest(&best);
+                Path path = alg.solveTSP();
+                const unsigned long elapsedTime = timer.getElapsedNs();
+
+                results[i] = new TestResult(instanceName, graph->getVertexCount(), elapsedTime, path, path.prd); });
+        }
+        pool.wait();
+    }
+
+    // Every run has its row, the runs skipped after the optimum was reached are marked as cancelled
+    int finishedCount = 0;
+    for (TestResult *result : results)
+    {
+        if (result != NULL)
+        {
+            FileUtils::appendTestResult(outputPath, *result);
+            delete result;
+            ++finishedCount;
+        }
+        else
+        {
+            FileUtils::appendCancelledTestResult(outputPath, instanceName, graph->getVertexCount());
+        }
+    }
+
+    printf("Finished runs: %i / %i, best path weight: %i\n", finishedCount, runCount, best.getWeight());
+    if (best.isTargetReached())
+    {
+        printf("The optimum has been reached, the remaining runs have been cancelled\n");
     }
 }
 
@@ -31,6 +290,9 @@ void Tests::randomInstanceTest(int minSize, int maxSize, int iterCountPerInstanc
 {
     FileUtils::writeRandomInstanceTestHeader(outputPath);
     Timer timer;
+    Trace traceFile;
+    Trace *trace = openTrace(&traceFile, outputPath, params);
+    SolveContext context;
     GraphMatrix *graph;
     printf("%i, %i\n", iterCountPerInstance, instanceCountPerSize);
 
@@ -46,8 +308,7 @@ void Tests::randomInstanceTest(int minSize, int maxSize, int iterCountPerInstanc
             for (int j = 0; j < iterCountPerInstance; ++j)
             {
                 timer.start();
-                SimulatedAnnealing alg(graph, params);
-                Path path = alg.solveTSP();
+                Path path = solve(graph, params, trace, &context);
                 averageTime += timer.getElapsedNs();
             }
             delete graph;
@@ -64,11 +325,15 @@ void Tests::testAlgorithm(std::vector<std::string> instances, AlgorithmParams pa
 
     for (std::string instanceName : instances)
     {
-        GraphMatrix *graph;
-        graph = FileUtils::loadGraph(instanceName);
+        std::string error;
+        GraphMatrix *graph = FileUtils::loadGraph(instanceName, &error);
+        if (graph == NULL)
+        {
+            printf("%s\n", error.c_str());
+            continue;
+        }
 
-        SimulatedAnnealing alg(graph, params);
-        Path path = alg.solveTSP();
+        Path path = solve(graph, params, NULL);
         const bool correctRes = path.weight == graph->optimum;
 
         printf("%14s", instanceName.c_str());
@@ -86,3 +351,375 @@ void Tests::testAlgorithm(std::vector<std::string> instances, AlgorithmParams pa
         graph = NULL;
     }
 }
+
+// Returns true if next() / prev() of `vertex` agree in both tours, `sameOrientation` = both are traversed in the same direction
+static bool sameNeighbors(ArrayTour &arrayTour, TwoLevelListTour &listTour, int vertex, bool sameOrientation)
+{
+    if (sameOrientation)
+    {
+        return listTour.next(vertex) == arrayTour.next(vertex) && listTour.prev(vertex) == arrayTour.prev(vertex);
+    }
+    return listTour.next(vertex) == arrayTour.prev(vertex) && listTour.prev(vertex) == arrayTour.next(vertex);
+}
+
+// Applies the 2-opt moves between the vertex pairs `moves` to an array tour and to a two-level list tour, compares
+// next() / prev() around every move and a random between() query, and the whole tours at the end.
+// Without keepOrientation the tours may be traversed in opposite directions, the moves and the queries follow that.
+// Returns the number of mismatches
+static int crossCheckTours(const std::vector<int> &path, const std::vector<int> &moves, bool keepOrientation, Random &rng)
+{
+    const int vertexCount = path.size();
+    const int moveCount = moves.size() / 2;
+    ArrayTour arrayTour(vertexCount, keepOrientation);
+    TwoLevelListTour listTour(vertexCount, keepOrientation);
+    arrayTour.set(path.data());
+    listTour.set(path.data());
+    int mismatches = 0;
+
+    for (int i = 0; i < moveCount; ++i)
+    {
+        const int a = moves[2 * i];
+        const int c = moves[2 * i + 1];
+        const bool sameOrientation = listTour.next(path[0]) == arrayTour.next(path[0]);
+        if (!sameOrientation && keepOrientation)
+        {
+            ++mismatches;
+        }
+
+        // Against the direction of the array tour, the part next(a) .. c runs from c to prev(a)
+        arrayTour.twoOptMove(a, c);
+        if (sameOrientation)
+        {
+            listTour.twoOptMove(a, c);
+        }
+        else
+        {
+            listTour.twoOptMove(listTour.prev(c), listTour.prev(a));
+        }
+
+        const bool orientation = listTour.next(path[0]) == arrayTour.next(path[0]);
+        const int x = rng.nextInt(vertexCount);
+        const int y = rng.nextInt(vertexCount);
+        const int z = rng.nextInt(vertexCount);
+        if (!sameNeighbors(arrayTour, listTour, a, orientation) || !sameNeighbors(arrayTour, listTour, c, orientation) ||
+            !sameNeighbors(arrayTour, listTour, x, orientation) ||
+            listTour.between(x, y, z) != (orientation ? arrayTour.between(x, y, z) : arrayTour.between(z, y, x)))
+        {
+            ++mismatches;
+        }
+    }
+
+    const bool orientation = listTour.next(path[0]) == arrayTour.next(path[0]);
+    for (int vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        if (!sameNeighbors(arrayTour, listTour, vertex, orientation))
+        {
+            ++mismatches;
+            break;
+        }
+    }
+    return mismatches;
+}
+
+// Times `moveCount` 2-opt moves between the vertex pairs `moves` and as many next() / between() queries
+template <class Tour>
+static void benchmarkTour(std::string tourName, const std::vector<int> &path, const std::vector<int> &moves, std::string outputPath)
+{
+    const int vertexCount = path.size();
+    const int moveCount = moves.size() / 2;
+    Tour tour(vertexCount, false);
+    tour.set(path.data());
+    Timer timer;
+
+    timer.start();
+    for (int i = 0; i < moveCount; ++i)
+    {
+        tour.twoOptMove(moves[2 * i], moves[2 * i + 1]);
+    }
+    const unsigned long moveTime = timer.getElapsedNs();
+
+    // The checksum keeps the queries from being optimized out
+    long checksum = 0;
+    timer.start();
+    for (int i = 0; i + 2 < 2 * moveCount; ++i)
+    {
+        checksum += tour.next(moves[i]) + tour.between(moves[i], moves[i + 1], moves[i + 2]);
+    }
+    const unsigned long queryTime = timer.getElapsedNs();
+
+    printf("%s, n = %i: %.1f ns per move, %.1f ns per query (%li)\n", tourName.c_str(), vertexCount,
+           (double)moveTime / moveCount, (double)queryTime / (2 * moveCount - 2), checksum);
+    FileUtils::appendTourBenchmarkResult(outputPath, tourName, vertexCount, moveCount, moveTime, 2 * moveCount - 2, queryTime);
+}
+
+void Tests::tourBenchmark(std::vector<int> sizes, int moveCount, std::string outputPath)
+{
+    FileUtils::writeTourBenchmarkHeader(outputPath);
+    Random rng(1);
+
+    for (int vertexCount : sizes)
+    {
+        if (vertexCount < 3 || moveCount < 2)
+        {
+            continue;
+        }
+
+        std::vector<int> path(vertexCount);
+        for (int i = 0; i < vertexCount; ++i)
+        {
+            path[i] = i;
+        }
+        for (int i = vertexCount - 1; i > 0; --i)
+        {
+            std::swap(path[i], path[rng.nextInt(i + 1)]);
+        }
+
+        // Both tours get the same moves (pairs of different vertices)
+        std::vector<int> moves(2 * moveCount);
+        for (int i = 0; i < moveCount; ++i)
+        {
+            moves[2 * i] = rng.nextInt(vertexCount);
+            moves[2 * i + 1] = (moves[2 * i] + 1 + rng.nextInt(vertexCount - 1)) % vertexCount;
+        }
+
+        // The two-level list tour is checked against the array tour first, in both orientation modes
+        for (int keepOrientation = 1; keepOrientation >= 0; --keepOrientation)
+        {
+            const int mismatches = crossCheckTours(path, moves, keepOrientation, rng);
+            printf("two_level_list, n = %i, %s orientation: %i moves checked against the array tour, %i mismatches",
+                   vertexCount, keepOrientation ? "kept" : "free", moveCount, mismatches);
+            if (mismatches == 0)
+            {
+                printColor(" PASS\n", GREEN, BOLD, BOLD);
+            }
+            else
+            {
+                printColor(" FAIL\n", RED, BOLD, BOLD);
+            }
+        }
+
+        benchmarkTour<ArrayTour>("array", path, moves, outputPath);
+        benchmarkTour<TwoLevelListTour>("two_level_list", path, moves, outputPath);
+    }
+    printf("Done. Saved to file.\n");
+}
+
+// Returns true if both graphs have the same weights, the same coordinates and the same optimum (when both know it)
+static bool sameGraph(GraphMatrix *a, GraphMatrix *b)
+{
+    const int vertexCount = a->getVertexCount();
+    if (b->getVertexCount() != vertexCount || a->directed != b->directed || a->x != b->x || a->y != b->y ||
+        (a->isOptimumKnown() && b->isOptimumKnown() && a->getOptimum() != b->getOptimum()))
+    {
+        return false;
+    }
+    for (int u = 0; u < vertexCount; ++u)
+    {
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            if (a->getWeight(u, v) != b->getWeight(u, v))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Tests::loaderBenchmark(std::string inputDir, std::string cacheDir, int repetitions, std::string outputPath)
+{
+    std::vector<std::string> fileNames;
+    DIR *dir = opendir(inputDir.c_str());
+    if (dir == NULL)
+    {
+        printf("Could not open the directory %s\n", inputDir.c_str());
+        return;
+    }
+    while (dirent *entry = readdir(dir))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            fileNames.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(fileNames.begin(), fileNames.end());
+
+    FileUtils::writeLoaderBenchmarkHeader(outputPath);
+    repetitions = std::max(repetitions, 1);
+    unsigned long totalStreamTime = 0;
+    unsigned long totalMmapTime = 0;
+    unsigned long totalCacheTime = 0;
+    Timer timer;
+
+    for (const std::string &fileName : fileNames)
+    {
+        const std::string filePath = inputDir + "/" + fileName;
+        std::string error;
+        GraphMatrix *graph = FileUtils::loadGraph(filePath, &error);
+        if (graph == NULL)
+        {
+            printf("%s\n", error.c_str());
+            continue;
+        }
+        // The former loader reads the explicit matrices only
+        if (graph->hasCoordinates())
+        {
+            printf("%s: a TSPLIB instance, not read by the stream loader\n", fileName.c_str());
+            delete graph;
+            continue;
+        }
+        GraphMatrix *reference = FileUtils::loadGraphWithStreams(filePath);
+        bool same = sameGraph(graph, reference);
+        delete reference;
+
+        // The cache file is written from the parsed graph, then read back with the checksum of its weights
+        const std::string cachePath = InstanceCache::cachePath(filePath, cacheDir);
+        mkdir(cacheDir.c_str(), 0755);
+        GraphMatrix *cached = NULL;
+        if (InstanceCache::write(cachePath, filePath, graph))
+        {
+            cached = InstanceCache::read(cachePath, filePath, true);
+        }
+        if (cached == NULL)
+        {
+            printf("%s: could not write the instance cache file %s\n", fileName.c_str(), cachePath.c_str());
+            delete graph;
+            continue;
+        }
+        same = same && sameGraph(graph, cached) && cached->name == graph->name;
+        delete cached;
+        delete graph;
+        if (!same)
+        {
+            printf("%s: the loaders read different graphs\n", fileName.c_str());
+            continue;
+        }
+
+        // The loaders alternate, so that all find the file in the page cache
+        unsigned long streamTime = 0;
+        unsigned long mmapTime = 0;
+        unsigned long cacheTime = 0;
+        int vertexCount = 0;
+        for (int i = 0; i < repetitions; ++i)
+        {
+            timer.start();
+            graph = FileUtils::loadGraphWithStreams(filePath);
+            streamTime += timer.getElapsedNs();
+            delete graph;
+
+            timer.start();
+            graph = FileUtils::loadGraph(filePath);
+            mmapTime += timer.getElapsedNs();
+            vertexCount = graph->getVertexCount();
+            delete graph;
+
+            timer.start();
+            graph = InstanceCache::read(cachePath, filePath);
+            cacheTime += timer.getElapsedNs();
+            delete graph;
+        }
+        streamTime /= repetitions;
+        mmapTime /= repetitions;
+        cacheTime /= repetitions;
+        totalStreamTime += streamTime;
+        totalMmapTime += mmapTime;
+        totalCacheTime += cacheTime;
+
+        struct stat st;
+        const long fileSize = stat(filePath.c_str(), &st) == 0 ? (long)st.st_size : 0;
+        printf("%14s, n = %4i: stream %8.3f ms, mmap %8.3f ms (x%.1f), cache %8.3f ms\n", fileName.c_str(),
+               vertexCount, streamTime / 1e6, mmapTime / 1e6, (double)streamTime / mmapTime, cacheTime / 1e6);
+        FileUtils::appendLoaderBenchmarkResult(outputPath, fileName, vertexCount, fileSize, streamTime, mmapTime,
+                                               cacheTime);
+    }
+    if (totalMmapTime > 0)
+    {
+        printf("\nAll files: stream %.1f ms, mmap %.1f ms (x%.1f), cache %.2f ms\n", totalStreamTime / 1e6,
+               totalMmapTime / 1e6, (double)totalStreamTime / totalMmapTime, totalCacheTime / 1e6);
+    }
+    printf("Done. Saved to file.\n");
+}
+
+// The validity check replaced by the context bitset: sorts a copy of the path
+static bool pathIsValidBySorting(const std::vector<int> &path)
+{
+    std::vector<int> sorted(path);
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < (int)sorted.size(); ++i)
+    {
+        if (sorted[i] != i)
+            return false;
+    }
+    return true;
+}
+
+void Tests::contextBenchmark(std::vector<int> sizes, int repetitions, std::string outputPath, AlgorithmParams params)
+{
+    FileUtils::writeContextBenchmarkHeader(outputPath);
+    repetitions = std::max(repetitions, 1);
+    Random rng(1);
+    Timer timer;
+
+    for (int vertexCount : sizes)
+    {
+        if (vertexCount < 1)
+        {
+            continue;
+        }
+        GraphMatrix *graph = graphGenerator::getRandom(vertexCount, 100);
+
+        // The checksum keeps the constructions and the checks from being optimized out
+        long checksum = 0;
+        timer.start();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            SimulatedAnnealing alg(graph, params);
+            checksum += alg.getBestWeight();
+        }
+        const unsigned long ownedTime = timer.getElapsedNs();
+
+        SolveContext context;
+        timer.start();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            SimulatedAnnealing alg(graph, params, &context);
+            checksum += alg.getBestWeight();
+        }
+        const unsigned long reusedTime = timer.getElapsedNs();
+
+        std::vector<int> path(vertexCount);
+        for (int i = 0; i < vertexCount; ++i)
+        {
+            path[i] = i;
+        }
+        for (int i = vertexCount - 1; i > 0; --i)
+        {
+            std::swap(path[i], path[rng.nextInt(i + 1)]);
+        }
+
+        timer.start();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            checksum += pathIsValidBySorting(path);
+        }
+        const unsigned long sortedCheckTime = timer.getElapsedNs();
+
+        SimulatedAnnealing alg(graph, params, &context);
+        timer.start();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            checksum += alg.pathIsValid(path.data());
+        }
+        const unsigned long bitsetCheckTime = timer.getElapsedNs();
+
+        printf("n = %i: construction %.1f ns (own buffers) / %.1f ns (reused context), "
+               "validity check %.1f ns (sorted copy) / %.1f ns (bitset) (%li)\n",
+               vertexCount, (double)ownedTime / repetitions, (double)reusedTime / repetitions,
+               (double)sortedCheckTime / repetitions, (double)bitsetCheckTime / repetitions, checksum);
+        FileUtils::appendContextBenchmarkResult(outputPath, vertexCount, repetitions, ownedTime, reusedTime,
+                                                sortedCheckTime, bitsetCheckTime);
+        delete graph;
+    }
+    printf("Done. Saved to file.\n");
+}